@@ -0,0 +1,349 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  arrangement.cpp
+ *
+ *    Description:  Planar arrangement of segments kept as doubly-connected edge list, built while sweeping.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:04:16
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "arrangement.h"
+
+void Arrangement::reset( const std::vector<Segment>& s )
+{
+	clear();
+	int numbers = 0;
+	for( auto& seg : s )
+		numbers = std::max( numbers, seg.getData()->number + 1 );
+
+	//data moves between segments while sweeping, so segments are recognized by their numbers
+	place.assign( numbers, -1 );
+	for( unsigned int i = 0; i < s.size(); ++i )
+	{
+		segments.push_back( s[i].getData() );
+		place[ s[i].getData()->number ] = i;
+	}
+	last.assign( s.size(), -1 );
+	touches.reserve( 2 * s.size() );
+	vertices.reserve( 2 * s.size() );
+	above.reserve( 2 * s.size() );
+}
+
+int Arrangement::vertexAt( double x, double y )
+{
+	//vertices are recorded in order of sweep, so ones left behind by sweep line can't be found again
+	while( recent_first < vertices.size() && smaller( vertices[recent_first].x, x, sweep_precision ) )
+		++recent_first;
+
+	//crossings computed for different pairs in one place might differ a little and other points might be swept between them
+	//vertices with the same x coordinate are sorted by y, so each such group is searched by binary search
+	auto by_place = []( const Vertex& a, const Vertex& b ) { return a.x < b.x || ( a.x == b.x && a.y < b.y ); };
+	for( auto itr = vertices.begin() + recent_first; itr != vertices.end(); )
+	{
+		Vertex low = { itr->x, y - sweep_precision, -1 };
+		itr = std::lower_bound( itr, vertices.end(), low, by_place );
+		if( itr != vertices.end() && itr->x == low.x && itr->y <= y + sweep_precision )
+			return itr - vertices.begin();
+		Vertex high = { low.x, std::numeric_limits<double>::infinity(), -1 };
+		itr = std::upper_bound( itr, vertices.end(), high, by_place );
+	}
+	Vertex v = { x, y, -1 };
+	vertices.push_back( v );
+	above.push_back( -1 );
+	return vertices.size() - 1;
+}
+
+void Arrangement::touch( int number, int vertex )
+{
+	int s = place[number];
+	if( last[s] == vertex )
+		return;
+	last[s] = vertex;
+	Touch t = { s, vertex };
+	touches.push_back( t );
+}
+
+void Arrangement::setAbove( int vertex, int number )
+{
+	above[vertex] = number == -1 ? -1 : place[number];
+}
+
+void Arrangement::build()
+{
+	//touches are sorted by segments keeping order of sweep, so vertices of every segment go along it
+	int n = segments.size();
+	first_vertex.assign( n + 1, 0 );
+	for( auto& t : touches )
+		++first_vertex[ t.segment + 1 ];
+	std::partial_sum( first_vertex.begin(), first_vertex.end(), first_vertex.begin() );
+	sequence.resize( touches.size() );
+	std::vector<int> filled( first_vertex.begin(), first_vertex.end() - 1 );
+	for( auto& t : touches )
+		sequence[ filled[t.segment]++ ] = t.vertex;
+	std::vector<Touch>().swap( touches );
+
+	//every two following vertices of segment make an edge, first half-edge goes along segment
+	std::vector<double> angles;
+	first_edge.assign( n + 1, 0 );
+	for( int s = 0; s < n; ++s )
+	{
+		first_edge[s] = half_edges.size();
+		const SegmentData *d = segments[s];
+		double forward = atan2( d->s_y, d->s_x );
+		double backward = atan2( -d->s_y, -d->s_x );
+		for( int i = first_vertex[s]; i + 1 < first_vertex[s + 1]; ++i )
+		{
+			HalfEdge e = { sequence[i], -1, -1, -1, d->number };
+			HalfEdge t = { sequence[i + 1], -1, -1, -1, d->number };
+			half_edges.push_back( e );
+			half_edges.push_back( t );
+			angles.push_back( forward );
+			angles.push_back( backward );
+		}
+	}
+	first_edge[n] = half_edges.size();
+
+	std::vector<int> alias;
+	linkEdges( angles, alias );
+	findFaces( angles, alias );
+	removeCopies( alias );
+
+	std::vector<int>().swap( sequence );
+	std::vector<int>().swap( first_vertex );
+	std::vector<int>().swap( first_edge );
+	std::vector<int>().swap( above );
+	std::vector<int>().swap( last );
+}
+
+void Arrangement::linkEdges( const std::vector<double>& angles, std::vector<int>& alias )
+{
+	//half-edges leaving every vertex
+	int m = half_edges.size();
+	std::vector<int> first( vertices.size() + 1, 0 );
+	for( auto& e : half_edges )
+		++first[ e.origin + 1 ];
+	std::partial_sum( first.begin(), first.end(), first.begin() );
+	std::vector<int> around( m );
+	std::vector<int> filled( first.begin(), first.end() - 1 );
+	for( int e = 0; e < m; ++e )
+		around[ filled[ half_edges[e].origin ]++ ] = e;
+
+	//overlapping segments give the same edge going from lower vertex to higher one, only first is kept
+	alias.resize( m );
+	std::iota( alias.begin(), alias.end(), 0 );
+	std::vector<int> leading( vertices.size(), -1 );
+	for( unsigned int v = 0; v < vertices.size(); ++v )
+	{
+		for( int i = first[v]; i < first[v + 1]; ++i )
+		{
+			int e = around[i];
+			if( e & 1 )
+				continue;
+			int& kept = leading[ half_edges[ twin(e) ].origin ];
+			if( kept != -1 && half_edges[kept].origin == (int)v ) {
+				alias[e] = kept;
+				alias[ twin(e) ] = twin(kept);
+			}
+			else {
+				kept = e;
+			}
+		}
+	}
+
+	//going around vertex counterclockwise, half-edge coming to it is followed by half-edge leaving it just before its twin
+	for( unsigned int v = 0; v < vertices.size(); ++v )
+	{
+		auto b = around.begin() + first[v];
+		auto e = std::remove_if( b, around.begin() + first[v + 1], [&]( int h ) { return alias[h] != h; } );
+		std::sort( b, e, [&]( int p, int q ) { return angles[p] < angles[q]; } );
+		int d = e - b;
+		if( d == 0 )
+			continue;
+		vertices[v].edge = *b;
+		for( int i = 0; i < d; ++i )
+		{
+			int in = twin( b[i] );
+			int out = b[ ( i + d - 1 ) % d ];
+			half_edges[in].next = out;
+			half_edges[out].prev = in;
+		}
+	}
+}
+
+void Arrangement::findFaces( const std::vector<double>& angles, const std::vector<int>& alias )
+{
+	int m = half_edges.size();
+	std::vector<int> cycle( m, -1 ), cycle_edge, cycle_face;
+	std::vector<int> hole_head( vertices.size(), -1 ), hole_next;
+	faces.clear();
+	Face unbounded = { -1, 0 };
+	faces.push_back( unbounded );
+	for( int e = 0; e < m; ++e )
+	{
+		if( alias[e] != e || cycle[e] != -1 )
+			continue;
+		int c = cycle_edge.size();
+		cycle_edge.push_back( e );
+		hole_next.push_back( -1 );
+
+		//vertices were recorded in order of sweep, so the first of them is the leftmost one
+		int leftmost = half_edges[e].origin;
+		int h = e;
+		do {
+			cycle[h] = c;
+			leftmost = std::min( leftmost, half_edges[h].origin );
+			h = half_edges[h].next;
+		} while( h != e );
+
+		//nothing lies left of the leftmost vertex, so cycle going around face has no direction to the left
+		//between half-edges at it, while cycle going around component has it at one of its passes
+		bool outside = false;
+		do {
+			int out = half_edges[h].next;
+			if( half_edges[out].origin == leftmost ) {
+				double turn = std::fmod( angles[ twin(h) ] - angles[out] + 2 * M_PI, 2 * M_PI );
+				double left = std::fmod( M_PI - angles[out] + 2 * M_PI, 2 * M_PI );
+				outside = outside || out == twin(h) || left < turn;
+			}
+			h = out;
+		} while( h != e );
+
+		if( !outside ) {
+			Face f = { e, 0 };
+			cycle_face.push_back( faces.size() );
+			faces.push_back( f );
+		}
+		else {
+			cycle_face.push_back( -1 );
+			hole_next[c] = hole_head[leftmost];
+			hole_head[leftmost] = c;
+		}
+	}
+
+	//vertices were recorded in order of sweep, so components come in order of their leftmost vertices
+	//segment directly above such vertex began earlier, so face lying below it is already known
+	std::vector<int> hole_count( faces.size() + 1, 0 );
+	for( unsigned int v = 0; v < vertices.size(); ++v )
+	{
+		for( int c = hole_head[v]; c != -1; c = hole_next[c] )
+		{
+			int face = 0;
+			int s = above[v];
+			if( s != -1 && first_vertex[s + 1] - first_vertex[s] >= 2 ) {
+				//edge of segment lying above vertex taken from right to left has face below segment on its left
+				//vertex of segment lying right above is taken as end of edge, face below edge on the left of it reaches down from it
+				auto b = sequence.begin() + first_vertex[s], e = sequence.begin() + first_vertex[s + 1];
+				int i = std::lower_bound( b + 1, e - 1, vertices[v].x, [&]( int w, double x ) { return vertices[w].x < x; } ) - b - 1;
+				int edge = twin( alias[ first_edge[s] + 2 * i ] );
+				face = std::max( cycle_face[ cycle[edge] ], 0 );
+			}
+			cycle_face[c] = face;
+			++hole_count[face + 1];
+		}
+	}
+
+	for( int e = 0; e < m; ++e )
+	{
+		if( alias[e] == e )
+			half_edges[e].face = cycle_face[ cycle[e] ];
+	}
+
+	//holes of every face are put together
+	std::partial_sum( hole_count.begin(), hole_count.end(), hole_count.begin() );
+	for( unsigned int f = 0; f < faces.size(); ++f )
+		faces[f].first_hole = hole_count[f];
+	holes.resize( hole_count.back() );
+	for( unsigned int c = 0; c < cycle_edge.size(); ++c )
+	{
+		if( faces[ cycle_face[c] ].outer != cycle_edge[c] )
+			holes[ hole_count[ cycle_face[c] ]++ ] = cycle_edge[c];
+	}
+}
+
+void Arrangement::removeCopies( const std::vector<int>& alias )
+{
+	int m = half_edges.size();
+	std::vector<int> index( m );
+	int k = 0;
+	for( int e = 0; e < m; e += 2 )
+	{
+		if( alias[e] != e )
+			continue;
+		index[e] = k++;
+		index[e + 1] = k++;
+	}
+	if( k == m )
+		return;
+
+	//half-edges are only moved down, so none is overwritten before it is moved
+	for( int e = 0; e < m; ++e )
+	{
+		if( alias[e] != e )
+			continue;
+		HalfEdge h = half_edges[e];
+		h.next = index[h.next];
+		h.prev = index[h.prev];
+		half_edges[ index[e] ] = h;
+	}
+	half_edges.resize( k );
+	for( auto& v : vertices )
+	{
+		if( v.edge != -1 )
+			v.edge = index[v.edge];
+	}
+	for( auto& f : faces )
+	{
+		if( f.outer != -1 )
+			f.outer = index[f.outer];
+	}
+	for( auto& h : holes )
+		h = index[h];
+}
+
+void Arrangement::clear()
+{
+	vertices.clear();
+	recent_first = 0;
+	half_edges.clear();
+	faces.clear();
+	holes.clear();
+	segments.clear();
+	place.clear();
+	touches.clear();
+	last.clear();
+	above.clear();
+	sequence.clear();
+	first_vertex.clear();
+	first_edge.clear();
+}
+
+void Arrangement::write( std::ostream& out ) const
+{
+	std::streamsize precision = out.precision( 17 );
+	out<<"vertices "<<vertices.size()<<"\n";
+	for( auto& v : vertices )
+		out<<v.x<<" "<<v.y<<" "<<v.edge<<"\n";
+	out<<"half_edges "<<half_edges.size()<<"\n";
+	for( auto& e : half_edges )
+		out<<e.origin<<" "<<e.next<<" "<<e.prev<<" "<<e.face<<" "<<e.segment<<"\n";
+	out<<"faces "<<faces.size()<<"\n";
+	for( auto& f : faces )
+		out<<f.outer<<" "<<f.first_hole<<"\n";
+	out<<"holes "<<holes.size()<<"\n";
+	for( int h : holes )
+		out<<h<<"\n";
+	out.precision( precision );
+}
@@ -0,0 +1,164 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  arrangement.h
+ *
+ *    Description:  Planar arrangement of segments kept as doubly-connected edge list, built while sweeping.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:04:16
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef ARRANGEMENT_H
+#define ARRANGEMENT_H
+
+#include <ostream>
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * planar subdivision made by segments, kept as doubly-connected edge list in flat arrays
+ * vertices are ending points and crossings of segments, edges are parts of segments between them
+ * sweep records every vertex once and appends it to segments passing through it,
+ * so after sweep every segment already has its vertices in order and arrangement is built without searching
+ */
+class Arrangement
+{
+public:
+	/*
+	 * vertex with one of half-edges leaving it, -1 if no edge leaves it
+	 */
+	struct Vertex {
+		double x, y;
+		int edge;
+	};
+
+	/*
+	 * half-edge going from its origin, its twin is half-edge of index differing in the lowest bit
+	 * face lies on the left side of half-edge, segment is number of segment containing it
+	 */
+	struct HalfEdge {
+		int origin;
+		int next, prev;
+		int face;
+		int segment;
+	};
+
+	/*
+	 * face bounded by cycle of half-edges going through outer, -1 for unbounded face
+	 * holes of face are outer cycles of components lying inside it, given by one of their half-edges
+	 * they are listed in holes from first_hole up to first_hole of next face or to the end for the last face
+	 */
+	struct Face {
+		int outer;
+		int first_hole;
+	};
+
+	Arrangement() : recent_first(0) {}
+
+	/*
+	 * prepare recording vertices of given segments, previous arrangement is removed
+	 */
+	void reset( const std::vector<Segment>& segments );
+	/*
+	 * get vertex in given point, points are given in order of sweep
+	 * the same vertex is returned for points of sweep lying in the same place, even if other points came between them
+	 */
+	int vertexAt( double x, double y );
+	/*
+	 * append vertex to segment of given number, unless it is its last vertex already
+	 */
+	void touch( int number, int vertex );
+	/*
+	 * remember segment lying directly above vertex when it was swept, -1 if there is none
+	 * it is needed only for vertices where segments begin
+	 */
+	void setAbove( int vertex, int number );
+	/*
+	 * build edges and faces from vertices recorded for every segment
+	 */
+	void build();
+	/*
+	 * remove arrangement
+	 */
+	void clear();
+
+	const std::vector<Vertex>& getVertices() const
+	{ return vertices; }
+	const std::vector<HalfEdge>& getHalfEdges() const
+	{ return half_edges; }
+	const std::vector<Face>& getFaces() const
+	{ return faces; }
+	const std::vector<int>& getHoles() const
+	{ return holes; }
+	static int twin( int edge )
+	{ return edge ^ 1; }
+
+	/*
+	 * write arrays of arrangement as text, every array is preceded by its name and size
+	 */
+	void write( std::ostream& out ) const;
+
+private:
+	/*
+	 * vertex recorded for segment while sweeping
+	 */
+	struct Touch {
+		int segment;
+		int vertex;
+	};
+
+	/*
+	 * link half-edges around every vertex sorted by given angles
+	 * overlapping segments give the same edge many times, alias of every copy is half-edge which is kept
+	 */
+	void linkEdges( const std::vector<double>& angles, std::vector<int>& alias );
+	/*
+	 * find faces of cycles of half-edges and put outer cycles of components into faces containing them
+	 */
+	void findFaces( const std::vector<double>& angles, const std::vector<int>& alias );
+	/*
+	 * remove copies of half-edges and move the rest down
+	 */
+	void removeCopies( const std::vector<int>& alias );
+
+	std::vector<Vertex> vertices;
+	std::vector<HalfEdge> half_edges;
+	std::vector<Face> faces;
+	std::vector<int> holes;
+
+	/*
+	 * data of recorded segments and their places in it for every number of segment
+	 */
+	std::vector<const SegmentData*> segments;
+	std::vector<int> place;
+	/*
+	 * first vertex which might still lie in place of sweep, earlier ones are left behind by sweep line
+	 */
+	unsigned int recent_first;
+	/*
+	 * vertices in order they were recorded and last vertex of every segment
+	 */
+	std::vector<Touch> touches;
+	std::vector<int> last;
+	/*
+	 * segment directly above every vertex
+	 */
+	std::vector<int> above;
+	/*
+	 * vertices of every segment in order along it, starting from first vertex of segment
+	 * and index of first half-edge of every segment, half-edges of segment go in the same order
+	 */
+	std::vector<int> sequence;
+	std::vector<int> first_vertex;
+	std::vector<int> first_edge;
+};
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  balaban.cpp
+ *
+ *    Description:  Finding intersections of segments with Balaban's intermediate algorithm.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 08:29:11
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <iterator>
+
+#include "balaban.h"
+#include "spatialIndex.h"
+
+BalabanSearch::BalabanSearch( const std::vector<Segment>& s ) : segments( s ), max_tolerance( 0 )
+{
+	for( unsigned int i = 0; i < segments.size(); ++i )
+	{
+		SegmentData *d = segments[i].getData();
+		if( d->vertical ) {
+			vertical.push_back( i );
+			continue;
+		}
+		Line l = { d->x1, d->y1, d->x2, d->y2, d->slope, d->tolerance, 0, 0, (int)i };
+		lines.push_back( l );
+		borders.push_back( d->x1 );
+		borders.push_back( d->x2 );
+		max_tolerance = std::max( max_tolerance, d->tolerance );
+	}
+
+	std::sort( borders.begin(), borders.end() );
+	borders.erase( std::unique( borders.begin(), borders.end() ), borders.end() );
+	for( auto& l : lines )
+	{
+		l.first = std::lower_bound( borders.begin(), borders.end(), l.x1 ) - borders.begin();
+		l.last = std::lower_bound( borders.begin(), borders.end(), l.x2 ) - borders.begin();
+	}
+
+	//lines beginning on the same border are sorted on it
+	std::sort( lines.begin(), lines.end(), []( const Line& a, const Line& b ) {
+			if( a.first != b.first )
+				return a.first < b.first;
+			if( a.y1 != b.y1 )
+				return a.y1 < b.y1;
+			return a.slope < b.slope;
+		} );
+	beginnings.resize( borders.size() + 1 );
+	unsigned int i = 0;
+	for( unsigned int c = 0; c < beginnings.size(); ++c )
+	{
+		while( i < lines.size() && lines[i].first < (int)c )
+			++i;
+		beginnings[c] = i;
+	}
+}
+
+void BalabanSearch::solve( const Reporter& r )
+{
+	report = r;
+	if( !lines.empty() ) {
+		std::vector<int> L, R;
+		for( int i = beginnings[0]; i < beginnings[1]; ++i )
+			L.push_back( i );
+		treeSearch( L, 0, borders.size() - 1, R );
+	}
+	searchVertical();
+}
+
+void BalabanSearch::treeSearch( std::vector<int>& L, int b, int e, std::vector<int>& R )
+{
+	if( e - b == 1 ) {
+		searchInStrip( L, b, e, R );
+		return;
+	}
+
+	//lines not taken as stairs cross some of them or end inside strip
+	std::vector<int> Q, rest, places;
+	split( L, b, e, Q, rest, places );
+	std::vector<int>().swap( L );
+	for( unsigned int i = 0; i < rest.size(); ++i )
+	{
+		walkStairs( Q, rest[i], places[i], borders[b], borders[ std::min( lines[ rest[i] ].last, e ) ], b, e );
+	}
+
+	//search both halves of strip, passing lines through border between them
+	int c = ( b + e ) / 2;
+	std::vector<int> left_R, right_L, right_R;
+	treeSearch( rest, b, c, left_R );
+	crossBorder( left_R, c, right_L );
+	std::vector<int>().swap( left_R );
+	treeSearch( right_L, c, e, right_R );
+
+	//lines beginning inside strip are found between stairs by their beginnings
+	if( !Q.empty() ) {
+		for( int i = beginnings[b + 1]; i < beginnings[e]; ++i )
+		{
+			const Line& l = lines[i];
+			int place = std::partition_point( Q.begin(), Q.end(), [&]( int q ) { return keyAt( lines[q], l.x1 ) <= l.y1; } ) - Q.begin();
+			walkStairs( Q, i, place, l.x1, borders[ std::min( l.last, e ) ], b, e );
+		}
+	}
+
+	merge( Q, right_R, e, R );
+}
+
+void BalabanSearch::searchInStrip( std::vector<int>& L, int b, int e, std::vector<int>& R )
+{
+	//every line spans strip, so lines left after taking staircase cross it
+	//staircases are taken until no line is left
+	std::vector<std::vector<int> > stairs;
+	std::vector<int> current;
+	current.swap( L );
+	while( !current.empty() )
+	{
+		std::vector<int> Q, rest, places;
+		split( current, b, e, Q, rest, places );
+		for( unsigned int i = 0; i < rest.size(); ++i )
+		{
+			walkStairs( Q, rest[i], places[i], borders[b], borders[e], b, e );
+		}
+		stairs.push_back( std::vector<int>() );
+		stairs.back().swap( Q );
+		current.swap( rest );
+	}
+
+	//lines of every staircase are sorted on right border as well
+	R.clear();
+	std::vector<int> merged;
+	for( auto s = stairs.rbegin(); s != stairs.rend(); ++s )
+	{
+		merge( *s, R, e, merged );
+		R.swap( merged );
+	}
+}
+
+void BalabanSearch::split( const std::vector<int>& L, int b, int e, std::vector<int>& Q, std::vector<int>& rest, std::vector<int>& places )
+{
+	for( int s : L )
+	{
+		const Line& l = lines[s];
+		bool stair = l.first <= b && l.last >= e;
+		if( stair && !Q.empty() ) {
+			//line has to lie above last stair on both borders
+			const Line& q = lines[ Q.back() ];
+			double tolerance = l.tolerance + q.tolerance;
+			stair = key( l, b ) - key( q, b ) > tolerance && key( l, e ) - key( q, e ) > tolerance;
+		}
+
+		if( stair ) {
+			Q.push_back( s );
+		}
+		else {
+			rest.push_back( s );
+			places.push_back( Q.size() );
+		}
+	}
+}
+
+void BalabanSearch::walkStairs( const std::vector<int>& Q, int line, int place, double from, double to, int b, int e )
+{
+	const Line& l = lines[line];
+	for( int i = place; i < (int)Q.size() && touches( l, lines[ Q[i] ], from, to ); ++i )
+	{
+		check( line, Q[i], b, e );
+	}
+	for( int i = place - 1; i >= 0 && touches( l, lines[ Q[i] ], from, to ); --i )
+	{
+		check( line, Q[i], b, e );
+	}
+}
+
+void BalabanSearch::crossBorder( const std::vector<int>& R, int c, std::vector<int>& L )
+{
+	std::vector<int> ending, passing, beginning;
+	for( int s : R )
+	{
+		if( lines[s].last == c )
+			ending.push_back( s );
+		else
+			passing.push_back( s );
+	}
+	for( int i = beginnings[c]; i < beginnings[c + 1]; ++i )
+		beginning.push_back( i );
+	merge( passing, beginning, c, L );
+
+	//lines ending on border can touch lines beginning on it only in their ending points
+	auto first = lines.begin() + beginnings[c], last = lines.begin() + beginnings[c + 1];
+	for( int s : ending )
+	{
+		const Line& l = lines[s];
+		double low = l.y2 - l.tolerance - max_tolerance;
+		double high = l.y2 + l.tolerance + max_tolerance;
+		for( auto itr = std::partition_point( first, last, [&]( const Line& other ) { return other.y1 < low; } ); itr != last && itr->y1 <= high; ++itr )
+		{
+			double x, y;
+			if( segments[l.index].intersects( segments[itr->index], x, y ) ) {
+				report( l.index, itr->index, x, y );
+			}
+		}
+	}
+}
+
+void BalabanSearch::merge( const std::vector<int>& a, const std::vector<int>& b, int border, std::vector<int>& result ) const
+{
+	result.clear();
+	result.reserve( a.size() + b.size() );
+	std::merge( a.begin(), a.end(), b.begin(), b.end(), std::back_inserter( result ), [&]( int s, int t ) {
+			double ks = key( lines[s], border );
+			double kt = key( lines[t], border );
+			if( ks != kt )
+				return ks < kt;
+			return lines[s].slope < lines[t].slope;
+		} );
+}
+
+bool BalabanSearch::touches( const Line& a, const Line& b, double from, double to ) const
+{
+	double tolerance = a.tolerance + b.tolerance;
+	double d1 = keyAt( a, from ) - keyAt( b, from );
+	double d2 = keyAt( a, to ) - keyAt( b, to );
+	return std::min( d1, d2 ) <= tolerance && std::max( d1, d2 ) >= -tolerance;
+}
+
+void BalabanSearch::check( int s, int t, int b, int e )
+{
+	const Line& p = lines[s];
+	const Line& q = lines[t];
+	double x, y;
+	if( !segments[p.index].intersects( segments[q.index], x, y ) )
+		return;
+
+	//the same crossing might be found in neighbouring strips
+	//it belongs to the leaf strip containing it, moved into strips spanned by both lines
+	int low = std::max( p.first, q.first );
+	int high = std::min( p.last, q.last ) - 1;
+	bool before = high < b || ( low < b && x < borders[b] );
+	bool after = low >= e || ( high >= e && x >= borders[e] );
+	if( before || after )
+		return;
+	report( p.index, q.index, x, y );
+}
+
+void BalabanSearch::searchVertical()
+{
+	if( vertical.empty() )
+		return;
+
+	SpatialIndex index;
+	index.build( segments );
+	index.crossingsOfVertical( segments, vertical, report );
+}
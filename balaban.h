@@ -0,0 +1,147 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  balaban.h
+ *
+ *    Description:  Finding intersections of segments with Balaban's intermediate algorithm.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 08:29:11
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef BALABAN_H
+#define BALABAN_H
+
+#include <functional>
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * class finding intersections of segments with Balaban's intermediate algorithm in O(n log^2 n + k) time
+ * plane is divided into strips between x coordinates of ending points, which are searched recursively
+ * every strip keeps staircase of segments spanning it and not crossing each other,
+ * so other segments are compared only with stairs they actually cross
+ * vertical segments have no width, they are checked with spatial index instead
+ */
+class BalabanSearch
+{
+public:
+	/*
+	 * function called for every found intersection with indices of crossing segments and coordinates of crossing
+	 */
+	typedef std::function<void( int, int, double, double )> Reporter;
+
+	/*
+	 * prepare searching of given segments, they can't change until search is finished
+	 */
+	BalabanSearch( const std::vector<Segment>& segments );
+
+	/*
+	 * find every intersection of segments, every pair of crossing segments is reported once
+	 */
+	void solve( const Reporter& report );
+
+private:
+	/*
+	 * non vertical segment with its line and range of strips it spans
+	 * first and last are indices of borders of strips at beginning and end of segment
+	 */
+	struct Line {
+		double x1, y1, x2, y2;
+		double slope, tolerance;
+		int first, last;
+		int index;
+	};
+
+	/*
+	 * get y coordinate of crossing of line with border of given index
+	 * ending points are returned exactly
+	 */
+	double key( const Line& l, int border ) const
+	{ return keyAt( l, borders[border] ); }
+	double keyAt( const Line& l, double x ) const
+	{
+		if( x == l.x1 )
+			return l.y1;
+		if( x == l.x2 )
+			return l.y2;
+		return l.y1 + ( x - l.x1 ) * l.slope;
+	}
+
+	/*
+	 * search strip between borders b and e, lines of L cross border b and are sorted on it
+	 * lines crossing border e are written into R sorted on it
+	 */
+	void treeSearch( std::vector<int>& L, int b, int e, std::vector<int>& R );
+	/*
+	 * search strip between neighbouring borders, every line of L spans it
+	 */
+	void searchInStrip( std::vector<int>& L, int b, int e, std::vector<int>& R );
+	/*
+	 * divide lines of L into staircase Q of lines spanning strip and not touching each other
+	 * and the rest, for every line of rest number of stairs below it on border b is remembered
+	 */
+	void split( const std::vector<int>& L, int b, int e, std::vector<int>& Q, std::vector<int>& rest, std::vector<int>& places );
+	/*
+	 * compare line with stairs of Q from given place up and down between given x coordinates
+	 * stairs don't touch each other, so walking stops at first stair not touching line
+	 */
+	void walkStairs( const std::vector<int>& Q, int line, int place, double from, double to, int b, int e );
+	/*
+	 * move lines from border c of strips, remove lines ending on it and insert lines beginning on it
+	 * lines ending on it are tested with lines beginning on it, they don't share any strip
+	 */
+	void crossBorder( const std::vector<int>& R, int c, std::vector<int>& L );
+	/*
+	 * merge two lists of lines sorted on border of given index
+	 */
+	void merge( const std::vector<int>& a, const std::vector<int>& b, int border, std::vector<int>& result ) const;
+	/*
+	 * test whether lines touch each other between given x coordinates
+	 */
+	bool touches( const Line& a, const Line& b, double from, double to ) const;
+	/*
+	 * test whether lines intersect and report them if crossing belongs to strip between borders b and e
+	 */
+	void check( int a, int b, int first, int last );
+
+	/*
+	 * check every vertical segment with spatial index built from every segment
+	 */
+	void searchVertical();
+
+	/*
+	 * searched segments
+	 */
+	const std::vector<Segment>& segments;
+	/*
+	 * function reporting found intersections
+	 */
+	Reporter report;
+	/*
+	 * non vertical segments sorted by their beginnings and indices of vertical segments
+	 */
+	std::vector<Line> lines;
+	std::vector<int> vertical;
+	/*
+	 * sorted different x coordinates of ending points of lines
+	 */
+	std::vector<double> borders;
+	/*
+	 * index of first line beginning on every border, last value is number of lines
+	 */
+	std::vector<int> beginnings;
+	/*
+	 * the biggest tolerance of any line
+	 */
+	double max_tolerance;
+};
+
+#endif
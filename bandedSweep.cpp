@@ -0,0 +1,260 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  bandedSweep.cpp
+ *
+ *    Description:  Sweep keeping opened segments in bands of y coordinates and their components in union-find,
+ *    				shared by out-of-core and streamed solvers.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 11:13:40
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "bandedSweep.h"
+#include "segment.h"
+
+BandedSweep::BandedSweep() : band_height(1), min_y(0), opened_count(0), closed_count(0), entries(0), entries_bytes(0),
+	intersections_count(0), components_count(0), max_opened(0)
+{
+	bands.resize( 1 );
+}
+
+void BandedSweep::reset( int bands_count, double m_band_height, double m_min_y )
+{
+	band_height = m_band_height > 0 ? m_band_height : 1;
+	min_y = m_min_y;
+	slots.clear();
+	parents.clear();
+	ranks.clear();
+	active.clear();
+	free_slots.clear();
+	ends.clear();
+	bands.assign( std::max( 1, bands_count ), std::vector<Entry>() );
+	std::vector<Entry>().swap( long_segments );
+	opened_count = closed_count = 0;
+	entries = entries_bytes = 0;
+	intersections_count = components_count = max_opened = 0;
+}
+
+long long BandedSweep::band( double y ) const
+{
+	//far bands share lists anyway, so band numbers are kept in range
+	double b = floor( ( y - min_y ) / band_height );
+	return (long long)std::max( -1e18, std::min( 1e18, b ) );
+}
+
+std::vector<BandedSweep::Entry>& BandedSweep::bandList( long long b )
+{
+	long long count = bands.size();
+	return bands[ ( b % count + count ) % count ];
+}
+
+bool BandedSweep::open( const Record& r )
+{
+	int slot;
+	if( free_slots.empty() ) {
+		slot = slots.size();
+		slots.push_back( Opened() );
+		parents.push_back( slot );
+		ranks.push_back( 0 );
+		active.push_back( 1 );
+	}
+	else {
+		slot = free_slots.back();
+		free_slots.pop_back();
+		parents[slot] = slot;
+		ranks[slot] = 0;
+		active[slot] = 1;
+	}
+	Opened& o = slots[slot];
+	o.r = r;
+	o.first_band = band( std::min( r.y1, r.y2 ) );
+	o.last_band = band( std::max( r.y1, r.y2 ) );
+	o.opened = true;
+	++opened_count;
+
+	//segment lying in too many bands would fill them, or would be put into one list many times
+	//so it is compared with every opened segment and kept in separate list
+	bool long_segment = o.last_band - o.first_band >= std::min<long long>( MAX_BAND_SPAN, bands.size() );
+	if( long_segment ) {
+		for( unsigned int s = 0; s < slots.size(); ++s )
+		{
+			if( (int)s != slot && slots[s].opened && !cross( slot, s ) )
+				return false;
+		}
+	}
+	else {
+		//compare new segment only with opened segments from the same bands
+		//pair of segments is compared only in first band they share, other bands kept in the same list are skipped
+		for( long long b = o.first_band; b <= o.last_band; ++b )
+		{
+			auto& list = bandList( b );
+			for( unsigned int i = 0; i < list.size(); )
+			{
+				if( stale( list[i] ) ) {
+					list[i] = list.back();
+					list.pop_back();
+					--entries;
+					continue;
+				}
+				const Opened& other = slots[ list[i].first ];
+				if( b <= other.last_band && std::max( o.first_band, other.first_band ) == b && !cross( slot, list[i].first ) )
+					return false;
+				++i;
+			}
+		}
+		for( unsigned int i = 0; i < long_segments.size(); )
+		{
+			if( stale( long_segments[i] ) ) {
+				long_segments[i] = long_segments.back();
+				long_segments.pop_back();
+				--entries;
+				continue;
+			}
+			if( !cross( slot, long_segments[i].first ) )
+				return false;
+			++i;
+		}
+	}
+
+	if( long_segment ) {
+		push( long_segments, Entry( slot, r.index ) );
+	}
+	else {
+		for( long long b = o.first_band; b <= o.last_band; ++b )
+			push( bandList( b ), Entry( slot, r.index ) );
+	}
+	ends.push_back( End( r.x2, slot ) );
+	std::push_heap( ends.begin(), ends.end(), std::greater<End>() );
+	max_opened = std::max<long long>( max_opened, ends.size() );
+
+	//too many stale entries, clean every list
+	if( entries > 2 * ( ends.size() * 4 + 1024 ) )
+		clean();
+	return true;
+}
+
+bool BandedSweep::cross( int slot, int other )
+{
+	const Record& a = slots[other].r;
+	const Record& b = slots[slot].r;
+	double x,y;
+	if( !segmentsIntersect( a.x1, a.y1, a.x2, a.y2, b.x1, b.y1, b.x2, b.y2, x, y ) )
+		return true;
+	++intersections_count;
+	if( report && !report( a.index, b.index, x, y ) )
+		return false;
+	join( slot, other );
+	return true;
+}
+
+void BandedSweep::push( std::vector<Entry>& list, const Entry& e )
+{
+	size_t capacity = list.capacity();
+	list.push_back( e );
+	entries_bytes += ( list.capacity() - capacity ) * sizeof(Entry);
+	++entries;
+}
+
+void BandedSweep::clean()
+{
+	auto is_stale = [this]( const Entry& e ) { return stale( e ); };
+	entries = 0;
+	for( auto& list : bands )
+	{
+		list.erase( std::remove_if( list.begin(), list.end(), is_stale ), list.end() );
+		entries += list.size();
+	}
+	long_segments.erase( std::remove_if( long_segments.begin(), long_segments.end(), is_stale ), long_segments.end() );
+	entries += long_segments.size();
+}
+
+void BandedSweep::closeBefore( double x )
+{
+	while( !ends.empty() && ends.front().first < x )
+	{
+		int slot = ends.front().second;
+		std::pop_heap( ends.begin(), ends.end(), std::greater<End>() );
+		ends.pop_back();
+		slots[slot].opened = false;
+		--opened_count;
+		++closed_count;
+		//component is finished when its last segment closes, nothing can join it later
+		if( --active[ find( slot ) ] == 0 )
+			++components_count;
+	}
+
+	if( closed_count > opened_count + 1024 )
+		compact();
+}
+
+int BandedSweep::find( int slot )
+{
+	while( parents[slot] != slot )
+	{
+		parents[slot] = parents[ parents[slot] ];
+		slot = parents[slot];
+	}
+	return slot;
+}
+
+void BandedSweep::join( int a, int b )
+{
+	a = find( a );
+	b = find( b );
+	if( a == b )
+		return;
+	if( ranks[a] < ranks[b] )
+		std::swap( a, b );
+	parents[b] = a;
+	active[a] += active[b];
+	if( ranks[a] == ranks[b] )
+		++ranks[a];
+}
+
+void BandedSweep::compact()
+{
+	//every opened segment points directly to first opened segment of its component
+	std::vector<int> roots( slots.size(), -1 ), representative( slots.size(), -1 );
+	for( unsigned int s = 0; s < slots.size(); ++s )
+	{
+		if( slots[s].opened )
+			roots[s] = find( s );
+	}
+	free_slots.clear();
+	for( unsigned int s = 0; s < slots.size(); ++s )
+	{
+		if( !slots[s].opened ) {
+			free_slots.push_back( s );
+			continue;
+		}
+		if( representative[ roots[s] ] == -1 )
+			representative[ roots[s] ] = s;
+		parents[s] = representative[ roots[s] ];
+		active[s] = 0;
+	}
+	for( unsigned int s = 0; s < slots.size(); ++s )
+	{
+		if( slots[s].opened ) {
+			++active[ parents[s] ];
+			ranks[s] = parents[s] == (int)s ? 1 : 0;
+		}
+	}
+	closed_count = 0;
+}
+
+size_t BandedSweep::memoryBytes() const
+{
+	size_t integers = parents.capacity() + ranks.capacity() + active.capacity() + free_slots.capacity() + 2 * slots.size();
+	return slots.capacity() * sizeof(Opened) + integers * sizeof(int) + ends.capacity() * sizeof(End)
+		+ bands.capacity() * sizeof(bands[0]) + entries_bytes;
+}
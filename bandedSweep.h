@@ -0,0 +1,185 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  bandedSweep.h
+ *
+ *    Description:  Sweep keeping opened segments in bands of y coordinates and their components in union-find,
+ *    				shared by out-of-core and streamed solvers.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 11:13:40
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef BANDED_SWEEP_H
+#define BANDED_SWEEP_H
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*
+ * class sweeping segments given in order of their beginnings, only segments crossing sweep line are kept
+ * opened segments are kept in bands of y coordinates and new segment is compared only with segments of its bands
+ * bands are mapped on fixed number of lists, segments lying in too many bands are kept in separate list
+ * connected components are joined only among opened segments, component is counted when its last segment closes
+ */
+class BandedSweep
+{
+public:
+	/*
+	 * single segment, beginning is never to the right of end
+	 */
+	struct Record {
+		double x1, y1, x2, y2;
+		long long index;
+	};
+
+	/*
+	 * function called for every found intersection with indices of crossing segments and coordinates of crossing
+	 * sweeping stops if it returns false
+	 */
+	typedef std::function<bool( long long, long long, double, double )> Reporter;
+
+	/*
+	 * segment lying in more bands is compared with every opened segment instead of being put into its bands
+	 */
+	static const int MAX_BAND_SPAN = 64;
+
+	BandedSweep();
+
+	/*
+	 * forget every segment and start new sweep with given number of lists of bands
+	 * band of y coordinate is counted from min_y by band_height
+	 */
+	void reset( int bands_count, double band_height, double min_y = 0 );
+
+	/*
+	 * set function called for every found intersection
+	 */
+	void setReporter( const Reporter& r )
+	{ report = r; }
+
+	/*
+	 * compare segment with opened segments, join crossing ones and open it
+	 * return false if reporter stopped sweeping
+	 */
+	bool open( const Record& r );
+	/*
+	 * close every segment ending before given x coordinate
+	 */
+	void closeBefore( double x );
+
+	/*
+	 * get number of bytes taken by opened segments, their union-find, ends and bands
+	 * compacting needs two more integers for every slot, so they are counted as well
+	 */
+	size_t memoryBytes() const;
+
+	/*
+	 * get number of intersections found so far
+	 */
+	long long getIntersectionsCount() const
+	{ return intersections_count; }
+	/*
+	 * get number of connected components whose every segment is closed
+	 */
+	long long getComponentsCount() const
+	{ return components_count; }
+	/*
+	 * get maximal number of segments opened at once
+	 */
+	long long getMaxOpened() const
+	{ return max_opened; }
+	/*
+	 * get height of bands of y coordinates
+	 */
+	double getBandHeight() const
+	{ return band_height; }
+
+private:
+	/*
+	 * segment opened by sweep line with first and last band it lies in
+	 * slot of closed segment stays in union-find until it is compacted
+	 */
+	struct Opened {
+		Record r;
+		long long first_band, last_band;
+		bool opened;
+	};
+	/*
+	 * slot and index of segment kept in list, entry is stale if slot was closed or reused
+	 */
+	typedef std::pair<int, long long> Entry;
+
+	/*
+	 * get band of y coordinate and list keeping given band
+	 */
+	long long band( double y ) const;
+	std::vector<Entry>& bandList( long long b );
+	/*
+	 * test whether entry is stale
+	 */
+	bool stale( const Entry& e ) const
+	{ return !slots[e.first].opened || slots[e.first].r.index != e.second; }
+	/*
+	 * report crossing of segments in given slots and join them, return false if reporter stopped sweeping
+	 */
+	bool cross( int slot, int other );
+	/*
+	 * add entry to list counting memory it takes
+	 */
+	void push( std::vector<Entry>& list, const Entry& e );
+	/*
+	 * remove stale entries from every list
+	 */
+	void clean();
+
+	/*
+	 * union-find of slots, active is number of opened segments of component kept in its root
+	 */
+	int find( int slot );
+	void join( int a, int b );
+	/*
+	 * free slots of closed segments, every component of opened segments gets one of them as its root
+	 */
+	void compact();
+
+	/*
+	 * bands are counted from min_y, band b is kept in list b modulo number of lists
+	 */
+	double band_height, min_y;
+	/*
+	 * slots of opened segments with their union-find, slots freed by compacting are reused
+	 */
+	std::vector<Opened> slots;
+	std::vector<int> parents, ranks, active;
+	std::vector<int> free_slots;
+	long long opened_count, closed_count;
+	/*
+	 * lists of bands and list of segments lying in too many bands
+	 * entries counts entries of every list, entries_bytes is memory taken by them
+	 */
+	std::vector<std::vector<Entry> > bands;
+	std::vector<Entry> long_segments;
+	size_t entries, entries_bytes;
+	/*
+	 * heap of ends of opened segments, segment with smallest end is on top
+	 */
+	typedef std::pair<double, int> End;
+	std::vector<End> ends;
+	Reporter report;
+	/*
+	 * statistics of sweeping
+	 */
+	long long intersections_count;
+	long long components_count;
+	long long max_opened;
+};
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  batch.cpp
+ *
+ *    Description:  Batch mode solving many instances of segments on a pool of threads.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:21:03
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "batch.h"
+
+BatchSolver::BatchSolver( const PlanarIntersections& c, int t ) : context( c ), threads( t ), choose_solvers( false ), solved_count( 0 ), failed_count( 0 )
+{
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+void BatchSolver::solveManifest( std::istream& manifest, std::ostream& out )
+{
+	std::vector<std::string> names;
+	std::string line;
+	while( std::getline( manifest, line ) )
+	{
+		if( !line.empty() )
+			names.push_back( line );
+	}
+
+	run( names, [&]( int i, Instance& instance ) {
+			std::ifstream in( names[i] );
+			return in && readInstance( in, instance );
+		}, out );
+}
+
+void BatchSolver::solveStream( std::istream& in, std::ostream& out )
+{
+	//stream can be read only in order, so every instance is read before solving
+	std::vector<Instance> instances;
+	std::vector<std::string> names;
+	Instance instance;
+	while( readInstance( in, instance ) )
+	{
+		instances.push_back( Instance() );
+		std::swap( instances.back(), instance );
+		names.push_back( "instance " + std::to_string( names.size() ) );
+	}
+
+	run( names, [&]( int i, Instance& loaded ) {
+			std::swap( loaded, instances[i] );
+			return true;
+		}, out );
+}
+
+bool BatchSolver::readInstance( std::istream& in, Instance& instance ) const
+{
+	int n;
+	if( !( in>>n ) || n < 0 )
+		return false;
+	instance.coordinates.resize( 4 * n );
+	instance.layers.assign( context.layered() ? n : 0, 0 );
+	for( int i = 0; i < n; ++i )
+	{
+		for( int c = 0; c < 4; ++c )
+			in>>instance.coordinates[4 * i + c];
+		if( context.layered() ) {
+			in>>instance.layers[i];
+			if( instance.layers[i] < 0 || instance.layers[i] >= PlanarIntersections::MAX_LAYERS )
+				return false;
+		}
+	}
+	return !in.fail();
+}
+
+void BatchSolver::run( const std::vector<std::string>& names, const Loader& load, std::ostream& out )
+{
+	int count = names.size();
+	std::vector<Result> results( count );
+	std::vector<bool> done( count, false );
+	int next_written = 0;
+	solved_count = failed_count = 0;
+	std::mutex writing;
+
+	//every thread takes next instance waiting for solving
+	std::atomic<int> next_instance( 0 );
+	auto worker = [&]() {
+		PlanarIntersections solver( context );
+		Instance instance;
+		int i;
+		while( ( i = next_instance++ ) < count )
+		{
+			Result r = { false, 0, 0, 0 };
+			if( load( i, instance ) ) {
+				solver.reset();
+				for( unsigned int s = 0; 4 * s < instance.coordinates.size(); ++s )
+				{
+					const double *c = &instance.coordinates[4 * s];
+					solver.addSegment( c[0], c[1], c[2], c[3], instance.layers.empty() ? 0 : instance.layers[s] );
+				}
+				if( choose_solvers )
+					solver.chooseSolvers();
+
+				auto start = std::chrono::steady_clock::now();
+				r.solved = solver.solve();
+				r.time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+				r.intersections = solver.getIntersectionsCount();
+				r.components = solver.countOnly() ? 0 : solver.countComponents();
+			}
+
+			//results are written in order of instances, the thread finishing the first missing one writes every ready one
+			std::lock_guard<std::mutex> lock( writing );
+			results[i] = r;
+			done[i] = true;
+			for( ; next_written < count && done[next_written]; ++next_written )
+			{
+				write( out, names[next_written], results[next_written] );
+				if( results[next_written].solved )
+					++solved_count;
+				else
+					++failed_count;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for( int t = 1; t < std::min( threads, count ); ++t )
+		workers.push_back( std::thread( worker ) );
+	worker();
+	for( auto& w : workers )
+		w.join();
+	out.flush();
+}
+
+void BatchSolver::write( std::ostream& out, const std::string& name, const Result& r ) const
+{
+	if( !r.solved ) {
+		out<<name<<": failed\n";
+		return;
+	}
+	out<<name<<": intersections "<<r.intersections;
+	if( !context.countOnly() )
+		out<<" components "<<r.components;
+	out<<" time "<<r.time<<"\n";
+}
@@ -0,0 +1,112 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  batch.h
+ *
+ *    Description:  Batch mode solving many instances of segments on a pool of threads.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:21:03
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "planarIntersections.h"
+
+/*
+ * class solving many independent sets of segments on a fixed pool of threads
+ * every thread keeps its own copy of configured context and reuses it for every instance it takes
+ * results are written in order of instances, each one as soon as every earlier one is written
+ */
+class BatchSolver
+{
+public:
+	/*
+	 * result of solving one instance, components are counted only if segments are connected
+	 */
+	struct Result {
+		bool solved;
+		long long intersections;
+		int components;
+		double time;
+	};
+
+	/*
+	 * solver using given number of threads, if it is not positive number of hardware threads is used
+	 * context sets how instances are solved, its segments are not used
+	 */
+	BatchSolver( const PlanarIntersections& context, int threads = 0 );
+
+	/*
+	 * set choosing solvers for every instance separately by probing its segments
+	 */
+	void setChooseSolvers( bool c )
+	{ choose_solvers = c; }
+
+	/*
+	 * solve instances from files listed in manifest, one path in every line
+	 * files are read by threads solving them
+	 */
+	void solveManifest( std::istream& manifest, std::ostream& out );
+	/*
+	 * solve instances given one after another in segments data format
+	 */
+	void solveStream( std::istream& in, std::ostream& out );
+
+	/*
+	 * get numbers of instances solved and failed by last call
+	 */
+	int getSolvedCount() const
+	{ return solved_count; }
+	int getFailedCount() const
+	{ return failed_count; }
+
+private:
+	/*
+	 * segments of one instance with layers if context is layered
+	 */
+	struct Instance {
+		std::vector<double> coordinates;
+		std::vector<int> layers;
+	};
+
+	/*
+	 * function writing instance of given index into given object, returns false if it can't be read
+	 */
+	typedef std::function<bool( int, Instance& )> Loader;
+
+	/*
+	 * read instance in segments data format, return false if there is no correct instance
+	 */
+	bool readInstance( std::istream& in, Instance& instance ) const;
+	/*
+	 * solve instances of given names loaded by given function on every thread
+	 */
+	void run( const std::vector<std::string>& names, const Loader& load, std::ostream& out );
+	/*
+	 * write result of instance
+	 */
+	void write( std::ostream& out, const std::string& name, const Result& r ) const;
+
+	/*
+	 * configured context copied by every thread
+	 */
+	const PlanarIntersections& context;
+	int threads;
+	bool choose_solvers;
+	int solved_count, failed_count;
+};
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  client.cpp
+ *
+ *    Description:  Client sending single request to solver server and printing its response.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:27:56
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "protocol.h"
+
+/*
+ * small client of solver server, sends one request and prints its response
+ */
+
+void printUsage()
+{
+	std::cout<<"Usage: planar_client SOCKET COMMAND [SET] [ARGUMENTS]"<<std::endl;
+	std::cout<<"Commands:"<<std::endl;
+	std::cout<<"  create                          create empty set and print its id"<<std::endl;
+	std::cout<<"  drop SET                        remove set"<<std::endl;
+	std::cout<<"  insert SET                      insert segments given in segments data format on standard input, print first id"<<std::endl;
+	std::cout<<"  remove SET ID...                remove segments of given ids"<<std::endl;
+	std::cout<<"  solve SET                       print number of intersections and connected components"<<std::endl;
+	std::cout<<"  query_segment SET X1 Y1 X2 Y2   print ids of segments crossing given segment"<<std::endl;
+	std::cout<<"  query_window SET X1 Y1 X2 Y2    print ids of segments lying in given rectangle"<<std::endl;
+	std::cout<<"  crossings SET ID                print ids of segments crossing given segment"<<std::endl;
+	std::cout<<"  components SET ID...            print component of every given segment, -1 for removed ones"<<std::endl;
+	std::cout<<"  shutdown                        stop server"<<std::endl;
+}
+
+template<class T>
+void put( std::vector<char>& payload, const T& value )
+{
+	const char *p = (const char*)&value;
+	payload.insert( payload.end(), p, p + sizeof( T ) );
+}
+
+template<class T>
+T get( const std::vector<char>& response, unsigned int i )
+{
+	T value;
+	memcpy( &value, response.data() + sizeof( T ) * i, sizeof( T ) );
+	return value;
+}
+
+/*
+ * send request and read response, return false if server can't be reached
+ */
+bool request( const std::string& path, uint32_t command, uint32_t set, const std::vector<char>& payload, ResponseHeader& header, std::vector<char>& response )
+{
+	sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	if( path.size() >= sizeof( address.sun_path ) )
+		return false;
+	strcpy( address.sun_path, path.c_str() );
+
+	int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( fd < 0 )
+		return false;
+	if( connect( fd, (sockaddr*)&address, sizeof( address ) ) < 0 ) {
+		close( fd );
+		return false;
+	}
+
+	RequestHeader request = { command, set, (uint32_t)payload.size() };
+	bool sent = sendAll( fd, &request, sizeof( request ) ) && sendAll( fd, payload.data(), payload.size() );
+	bool received = sent && receiveAll( fd, &header, sizeof( header ) );
+	if( received ) {
+		response.resize( header.size );
+		received = receiveAll( fd, response.data(), header.size );
+	}
+	close( fd );
+	return received;
+}
+
+int main( int argc, char *argv[] )
+{
+	if( argc < 3 ) {
+		printUsage();
+		return 1;
+	}
+	std::string path = argv[1], name = argv[2];
+	const char *names[] = { "create", "drop", "insert", "remove", "solve", "query_segment", "query_window", "crossings", "components", "shutdown" };
+	uint32_t command = 0;
+	for( unsigned int c = 0; c < sizeof( names ) / sizeof( names[0] ); ++c )
+	{
+		if( name == names[c] )
+			command = CREATE_SET + c;
+	}
+	bool needs_set = command != CREATE_SET && command != SHUTDOWN_SERVER;
+	if( command == 0 || ( needs_set && argc < 4 ) ) {
+		printUsage();
+		return 1;
+	}
+	uint32_t set = needs_set ? strtoul( argv[3], nullptr, 10 ) : 0;
+
+	//build payload from arguments or standard input
+	std::vector<char> payload;
+	if( command == INSERT_SEGMENTS ) {
+		int n;
+		std::cin>>n;
+		for( int i = 0; i < 4 * n; ++i )
+		{
+			double c;
+			std::cin>>c;
+			put( payload, c );
+		}
+		if( std::cin.fail() ) {
+			std::cout<<"Couldn't read segments"<<std::endl;
+			return 1;
+		}
+	}
+	else if( command == QUERY_SEGMENT || command == QUERY_WINDOW ) {
+		if( argc != 8 ) {
+			printUsage();
+			return 1;
+		}
+		for( int i = 4; i < 8; ++i )
+			put( payload, atof( argv[i] ) );
+	}
+	else if( command == REMOVE_SEGMENTS || command == SEGMENT_CROSSINGS || command == SEGMENT_COMPONENTS ) {
+		for( int i = 4; i < argc; ++i )
+			put<uint32_t>( payload, strtoul( argv[i], nullptr, 10 ) );
+	}
+
+	ResponseHeader header;
+	std::vector<char> response;
+	if( !request( path, command, set, payload, header, response ) ) {
+		std::cout<<"Couldn't reach server on "<<path<<std::endl;
+		return 1;
+	}
+	if( header.status != STATUS_OK ) {
+		const char *statuses[] = { "ok", "bad request", "no such set", "solving failed" };
+		std::cout<<"Request failed: "<<( header.status < 4 ? statuses[header.status] : "unknown status" )<<std::endl;
+		return 1;
+	}
+
+	switch( command )
+	{
+	case CREATE_SET:
+		std::cout<<get<uint32_t>( response, 0 )<<std::endl;
+		break;
+	case INSERT_SEGMENTS:
+		std::cout<<"First id: "<<get<uint32_t>( response, 0 )<<" Inserted: "<<get<uint32_t>( response, 1 )<<std::endl;
+		break;
+	case REMOVE_SEGMENTS:
+		std::cout<<"Removed: "<<get<uint32_t>( response, 0 )<<std::endl;
+		break;
+	case SOLVE_SET: {
+		int64_t intersections;
+		uint32_t components;
+		double time;
+		memcpy( &intersections, response.data(), sizeof( intersections ) );
+		memcpy( &components, response.data() + sizeof( intersections ), sizeof( components ) );
+		memcpy( &time, response.data() + sizeof( intersections ) + sizeof( components ), sizeof( time ) );
+		std::cout<<"Intersections: "<<intersections<<" Connected components: "<<components<<std::endl;
+		std::cout<<"Time taken: "<<time<<std::endl;
+		break;
+	}
+	case QUERY_SEGMENT:
+	case QUERY_WINDOW:
+	case SEGMENT_CROSSINGS:
+		for( unsigned int i = 0; i < response.size() / sizeof( uint32_t ); ++i )
+			std::cout<<( i ? " " : "" )<<get<uint32_t>( response, i );
+		std::cout<<std::endl;
+		break;
+	case SEGMENT_COMPONENTS:
+		for( unsigned int i = 0; i < response.size() / sizeof( int32_t ); ++i )
+			std::cout<<( i ? " " : "" )<<get<int32_t>( response, i );
+		std::cout<<std::endl;
+		break;
+	}
+	return 0;
+}
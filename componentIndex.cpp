@@ -0,0 +1,108 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  componentIndex.cpp
+ *
+ *    Description:  Index of connected components of solved segments with their members and statistics.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:35:49
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "componentIndex.h"
+
+void ComponentIndex::clear()
+{
+	component.clear();
+	offsets.clear();
+	members.clear();
+	stats.clear();
+}
+
+void ComponentIndex::build( const std::vector<Segment>& segments, int threads )
+{
+	clear();
+	int n = segments.size();
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+
+	//data moves between segments while sweeping, so it is placed by numbers first
+	//groups are numbers of segments or counted from zero, so every one is smaller than number of segments
+	//segment without group was not connected by graph solver, it is taken as component on its own
+	//and keyed after every group, so it is never mistaken for group of the same number
+	std::vector<const SegmentData*> numbered( n );
+	component.resize( n );
+	for( auto& s : segments )
+	{
+		const SegmentData *d = s.getData();
+		numbered[ d->number ] = d;
+		component[ d->number ] = d->group >= 0 && d->group < n ? d->group : n + d->number;
+	}
+
+	//dense labels are given in order of first member, then members are sorted by components
+	std::vector<int> label( 2 * n, -1 );
+	offsets.push_back( 0 );
+	for( int i = 0; i < n; ++i )
+	{
+		int& l = label[ component[i] ];
+		if( l == -1 ) {
+			l = offsets.size() - 1;
+			offsets.push_back( 0 );
+		}
+		component[i] = l;
+		++offsets[l + 1];
+	}
+	int count = offsets.size() - 1;
+	for( int c = 0; c < count; ++c )
+		offsets[c + 1] += offsets[c];
+	members.resize( n );
+	std::vector<int> next( offsets.begin(), offsets.end() - 1 );
+	for( int i = 0; i < n; ++i )
+		members[ next[ component[i] ]++ ] = i;
+
+	//components are divided between threads, every one is summed by single thread
+	stats.resize( count );
+	std::atomic<int> next_component( 0 );
+	const int chunk = 256;
+	auto worker = [&]() {
+		int first;
+		while( ( first = next_component.fetch_add( chunk ) ) < count )
+		{
+			for( int c = first; c < std::min( first + chunk, count ); ++c )
+			{
+				ComponentStats& st = stats[c];
+				const SegmentData *d = numbered[ members[ offsets[c] ] ];
+				st = { offsets[c + 1] - offsets[c], d->x1, std::min( d->y1, d->y2 ), d->x2, std::max( d->y1, d->y2 ), 0 };
+				for( int m = offsets[c]; m < offsets[c + 1]; ++m )
+				{
+					d = numbered[ members[m] ];
+					//x1 is never bigger than x2
+					st.min_x = std::min( st.min_x, d->x1 );
+					st.max_x = std::max( st.max_x, d->x2 );
+					st.min_y = std::min( st.min_y, std::min( d->y1, d->y2 ) );
+					st.max_y = std::max( st.max_y, std::max( d->y1, d->y2 ) );
+					st.length += sqrt( d->s_x * d->s_x + d->s_y * d->s_y );
+				}
+			}
+		}
+	};
+
+	threads = std::min( threads, ( count + chunk - 1 ) / chunk );
+	std::vector<std::thread> workers;
+	for( int t = 1; t < threads; ++t )
+		workers.push_back( std::thread( worker ) );
+	worker();
+	for( auto& w : workers )
+		w.join();
+}
@@ -0,0 +1,102 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  componentIndex.h
+ *
+ *    Description:  Index of connected components of solved segments with their members and statistics.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:35:49
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef COMPONENT_INDEX_H
+#define COMPONENT_INDEX_H
+
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * size, bounding box and total length of segments of connected component
+ */
+struct ComponentStats {
+	int size;
+	double min_x, min_y, max_x, max_y;
+	double length;
+};
+
+/*
+ * connected components of solved segments numbered densely and independently of graph solver
+ * components are numbered in order of smallest numbers of their segments, segments are given by their numbers
+ * members of every component are kept in one array sorted by component, so listing component takes time of its size
+ * once built it is read only, so it can be searched from many threads at once
+ */
+class ComponentIndex
+{
+public:
+	ComponentIndex() {}
+
+	/*
+	 * build index from groups set by graph solver using given number of threads, clears previous content
+	 * if threads is not positive number of hardware threads is used
+	 */
+	void build( const std::vector<Segment>& segments, int threads = 0 );
+
+	/*
+	 * remove every component from index
+	 */
+	void clear();
+
+	/*
+	 * get number of connected components
+	 */
+	int getComponentsCount() const
+	{ return stats.size(); }
+
+	/*
+	 * get component of segment of given number
+	 */
+	int componentOf( int number ) const
+	{ return component[number]; }
+
+	/*
+	 * test whether segments of given numbers are in the same component
+	 */
+	bool connected( int a, int b ) const
+	{ return component[a] == component[b]; }
+
+	/*
+	 * get numbers of segments of given component sorted increasingly
+	 * pointers to first and past last member are returned
+	 */
+	const int *membersBegin( int c ) const
+	{ return members.data() + offsets[c]; }
+	const int *membersEnd( int c ) const
+	{ return members.data() + offsets[c + 1]; }
+
+	/*
+	 * get size, bounding box and length of given component
+	 */
+	const ComponentStats& getStats( int c ) const
+	{ return stats[c]; }
+
+private:
+	/*
+	 * component of every segment by its number
+	 */
+	std::vector<int> component;
+	/*
+	 * numbers of segments of component c are members[offsets[c]] ... members[offsets[c + 1] - 1]
+	 */
+	std::vector<int> offsets;
+	std::vector<int> members;
+	std::vector<ComponentStats> stats;
+};
+
+#endif
@@ -32,6 +32,23 @@ void DisjointSet::makeSet( int x )
 	ranks[x] = 0;
 }
 
+void DisjointSet::reset( int n )
+{
+	parents.resize( n );
+	ranks.assign( n, 0 );
+	for( int i = 0; i < n; ++i )
+	{
+		parents[i] = i;
+	}
+}
+
+int DisjointSet::add()
+{
+	parents.push_back( parents.size() );
+	ranks.push_back( 0 );
+	return parents.size() - 1;
+}
+
 void DisjointSet::makeUnion( int x, int y )
 {
 	int xRoot = find(x);
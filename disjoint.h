@@ -16,6 +16,9 @@
  *
  * =====================================================================================
  */
+#ifndef DISJOINT_H
+#define DISJOINT_H
+
 #include <vector>
 
 /*
@@ -33,6 +36,15 @@ public:
 	 * create new set for this element
 	 */
 	void makeSet( int );
+	/*
+	 * add new element in its own set and return it
+	 */
+	int add();
+	/*
+	 * make given number of elements, each in its own set
+	 * memory of previous elements is reused
+	 */
+	void reset( int );
 	/*
 	 * return root of set given element belongs to
 	 * set parent of that element to root
@@ -59,3 +71,5 @@ private:
 	 */ 
 	std::vector<int> ranks;
 };
+
+#endif
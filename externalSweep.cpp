@@ -0,0 +1,239 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  externalSweep.cpp
+ *
+ *    Description:  Out-of-core sweep finding intersections and connected components of segments kept on disk,
+ *    				every buffer and opened segments are limited by --mem-limit.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 07:43:50
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+#include "externalSweep.h"
+
+namespace {
+
+/*
+ * buffered reader of one sorted run
+ */
+struct RunReader {
+	FILE *file;
+	std::vector<ExternalSweep::Record> records;
+	size_t position;
+
+	/*
+	 * read next part of run, return false if run ended
+	 */
+	bool fill()
+	{
+		records.resize( records.capacity() );
+		size_t n = fread( records.data(), sizeof(ExternalSweep::Record), records.size(), file );
+		records.resize( n );
+		position = 0;
+		return n > 0;
+	}
+};
+
+}
+
+ExternalSweep::ExternalSweep( size_t m_mem_limit, const std::string& m_tmp_dir ) :
+	mem_limit(m_mem_limit), tmp_dir(m_tmp_dir), pairs_file(nullptr), write_failed(false), exceeded_memory(false),
+	min_y( std::numeric_limits<double>::max() ), max_y( std::numeric_limits<double>::lowest() ), sum_height(0),
+	segments_count(0), max_opened_bytes(0)
+{
+	//half of memory for sorting runs, then quarter for merging them and eighth for pairs, rest is left for opened segments
+	buffer_capacity = std::max<size_t>( 1, mem_limit / 2 / sizeof(Record) );
+	pairs_capacity = std::max<size_t>( 1, mem_limit / 8 / sizeof(std::pair<long long, long long>) );
+}
+
+ExternalSweep::~ExternalSweep()
+{
+	for( auto f : runs )
+		fclose( f );
+	if( pairs_file != nullptr )
+		fclose( pairs_file );
+	for( auto& p : paths )
+		unlink( p.c_str() );
+}
+
+FILE *ExternalSweep::createTemporary()
+{
+	std::string path = tmp_dir + "/planarXXXXXX";
+	std::vector<char> name( path.begin(), path.end() );
+	name.push_back( '\0' );
+	int fd = mkstemp( name.data() );
+	if( fd == -1 )
+		return nullptr;
+	paths.push_back( name.data() );
+	FILE *f = fdopen( fd, "w+b" );
+	if( f == nullptr )
+		close( fd );
+	return f;
+}
+
+void ExternalSweep::addSegment( double a, double b, double c, double d )
+{
+	if( buffer.capacity() < buffer_capacity )
+		buffer.reserve( buffer_capacity );
+
+	//x1,y1 - beginning
+	//x2,y2 - end, vertical segments are directed up like in Segment
+	Record r;
+	if( a < c || ( a == c && b <= d ) ) {
+		r.x1 = a; r.y1 = b; r.x2 = c; r.y2 = d;
+	}
+	else {
+		r.x1 = c; r.y1 = d; r.x2 = a; r.y2 = b;
+	}
+	r.index = segments_count++;
+	min_y = std::min( min_y, std::min( b, d ) );
+	max_y = std::max( max_y, std::max( b, d ) );
+	sum_height += fabs( d - b );
+
+	buffer.push_back( r );
+	if( buffer.size() >= buffer_capacity && !flushRun() )
+		write_failed = true;
+}
+
+bool ExternalSweep::flushRun()
+{
+	if( buffer.empty() )
+		return true;
+
+	std::sort( buffer.begin(), buffer.end(), []( const Record& r1, const Record& r2 )
+			{ return r1.x1 == r2.x1 ? r1.y1 < r2.y1 : r1.x1 < r2.x1; } );
+
+	FILE *f = createTemporary();
+	if( f == nullptr )
+		return false;
+	runs.push_back( f );
+	bool written = fwrite( buffer.data(), sizeof(Record), buffer.size(), f ) == buffer.size();
+	buffer.clear();
+	return written;
+}
+
+bool ExternalSweep::spillPair( long long s1, long long s2 )
+{
+	if( pairs_file == nullptr )
+		return true;
+	pairs.push_back( std::make_pair( s1, s2 ) );
+	if( pairs.size() < pairs_capacity )
+		return true;
+	return flushPairs();
+}
+
+bool ExternalSweep::flushPairs()
+{
+	for( auto& p : pairs )
+		fprintf( pairs_file, "%lld %lld\n", p.first, p.second );
+	pairs.clear();
+	return !ferror( pairs_file );
+}
+
+bool ExternalSweep::solve()
+{
+	max_opened_bytes = 0;
+	exceeded_memory = false;
+	if( write_failed || !flushRun() )
+		return false;
+	//memory of runs buffer is not needed anymore
+	std::vector<Record>().swap( buffer );
+
+	if( !pairs_path.empty() ) {
+		pairs_file = fopen( pairs_path.c_str(), "w" );
+		if( pairs_file == nullptr )
+			return false;
+		pairs.reserve( pairs_capacity );
+	}
+
+	bool solved = sweep();
+	if( pairs_file != nullptr ) {
+		solved = fclose( pairs_file ) == 0 && solved;
+		pairs_file = nullptr;
+	}
+	std::vector<std::pair<long long, long long> >().swap( pairs );
+	return solved;
+}
+
+bool ExternalSweep::sweep()
+{
+	//every run gets equal part of quarter of memory for reading
+	std::vector<RunReader> readers( runs.size() );
+	size_t read_size = std::max<size_t>( 1, mem_limit / 4 / sizeof(Record) / std::max<size_t>( 1, runs.size() ) );
+
+	//memory left by buffers of runs and pairs is all opened segments can take
+	size_t fixed = runs.size() * ( read_size * sizeof(Record) + sizeof(RunReader) + sizeof(int) );
+	if( pairs_file != nullptr )
+		fixed += pairs_capacity * sizeof(std::pair<long long, long long>);
+	if( fixed >= mem_limit ) {
+		exceeded_memory = true;
+		return false;
+	}
+	size_t opened_limit = mem_limit - fixed;
+
+	//heap of runs ordered by their current segment, smallest on top
+	auto later = [&]( int r1, int r2 ) {
+		const Record& a = readers[r1].records[ readers[r1].position ];
+		const Record& b = readers[r2].records[ readers[r2].position ];
+		return a.x1 == b.x1 ? a.y1 > b.y1 : a.x1 > b.x1;
+	};
+	std::priority_queue<int, std::vector<int>, decltype(later)> merge( later );
+	for( unsigned int i = 0; i < runs.size(); ++i )
+	{
+		rewind( runs[i] );
+		readers[i].file = runs[i];
+		readers[i].records.reserve( read_size );
+		if( readers[i].fill() )
+			merge.push( i );
+	}
+
+	//each band of y coordinates keeps slots of opened segments lying in it
+	//band is at least as high as average segment, so most segments lie in one or two bands
+	//empty bands take at most eighth of memory left
+	int bands_count = std::max<int>( 1, std::min<size_t>( 1024, opened_limit / 8 / sizeof(std::vector<int>) ) );
+	if( sum_height > 0 )
+		bands_count = std::max( 1, std::min<int>( bands_count, ( max_y - min_y ) * segments_count / sum_height ) );
+	sweeper.reset( bands_count, ( max_y - min_y ) / bands_count, min_y );
+	sweeper.setReporter( [this]( long long s1, long long s2, double, double ) { return spillPair( s1, s2 ); } );
+
+	while( !merge.empty() )
+	{
+		int r = merge.top();
+		merge.pop();
+		Record s = readers[r].records[ readers[r].position++ ];
+		if( readers[r].position < readers[r].records.size() || readers[r].fill() )
+			merge.push( r );
+
+		sweeper.closeBefore( s.x1 );
+		if( !sweeper.open( s ) )
+			return false;
+
+		//opened segments can't be moved to disk, so solving stops when they outgrow memory left for them
+		size_t bytes = sweeper.memoryBytes();
+		max_opened_bytes = std::max( max_opened_bytes, bytes );
+		if( bytes > opened_limit ) {
+			exceeded_memory = true;
+			return false;
+		}
+	}
+	sweeper.closeBefore( std::numeric_limits<double>::infinity() );
+
+	//write rest of intersections
+	if( pairs_file != nullptr && !flushPairs() )
+		return false;
+	return true;
+}
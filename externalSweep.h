@@ -0,0 +1,176 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  externalSweep.h
+ *
+ *    Description:  Out-of-core sweep finding intersections and connected components of segments kept on disk,
+ *    				every buffer and opened segments are limited by --mem-limit.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 07:43:50
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef EXTERNAL_SWEEP_H
+#define EXTERNAL_SWEEP_H
+
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bandedSweep.h"
+
+/*
+ * class solving intersections of segments which don't fit into memory
+ * segments are sorted by beginnings in chunks written to temporary files,
+ * chunks are merged while sweeping the plane and only opened segments are kept in memory by banded sweep
+ * found intersections can be written to file through buffer of limited size
+ */
+class ExternalSweep
+{
+public:
+	/*
+	 * create solver using no more than given number of bytes
+	 * half of them is used for sorting runs, then for merging runs, opened segments and buffer of pairs
+	 * temporary files are created in given directory
+	 */
+	ExternalSweep( size_t mem_limit, const std::string& tmp_dir = "/tmp" );
+	/*
+	 * remove every temporary file
+	 */
+	~ExternalSweep();
+
+	/*
+	 * add single segment, if buffer is full it is sorted and written to disk
+	 */
+	void addSegment( double, double, double, double );
+
+	/*
+	 * set file to which pairs of crossing segments are written while sweeping, empty path writes no pairs
+	 */
+	void setPairsPath( const std::string& path )
+	{ pairs_path = path; }
+
+	/*
+	 * find every intersection and connected components of added segments
+	 * return false if files couldn't be written or solving needed more memory than limit
+	 */
+	bool solve();
+
+	/*
+	 * return whether last solving failed because opened segments or buffers didn't fit into memory limit
+	 */
+	bool exceededMemory() const
+	{ return exceeded_memory; }
+
+	/*
+	 * get number of added segments
+	 */
+	long long getSegmentsCount() const
+	{ return segments_count; }
+	/*
+	 * get number of intersections found by solving
+	 */
+	long long getIntersectionsCount() const
+	{ return sweeper.getIntersectionsCount(); }
+	/*
+	 * get number of connected components found by solving
+	 */
+	long long getComponentsCount() const
+	{ return sweeper.getComponentsCount(); }
+	/*
+	 * get number of sorted chunks written to disk
+	 */
+	int getRunsCount() const
+	{ return runs.size(); }
+	/*
+	 * get maximal number of segments opened at once during sweeping
+	 */
+	long long getMaxOpened() const
+	{ return sweeper.getMaxOpened(); }
+	/*
+	 * get the biggest number of bytes used by opened segments during sweeping
+	 */
+	size_t getMaxOpenedBytes() const
+	{ return max_opened_bytes; }
+
+	/*
+	 * single segment as stored on disk, beginning is never to the right of end
+	 */
+	typedef BandedSweep::Record Record;
+
+private:
+
+	/*
+	 * sort buffered segments and write them to new temporary file
+	 */
+	bool flushRun();
+	/*
+	 * create new temporary file and open it for reading and writing
+	 */
+	FILE *createTemporary();
+
+	/*
+	 * sweep plane with segments merged from every run, join crossing segments and write found intersections
+	 */
+	bool sweep();
+
+	/*
+	 * write pair of crossing segments to buffer, flush it to file if it's full
+	 */
+	bool spillPair( long long, long long );
+	bool flushPairs();
+
+	/*
+	 * memory limit and directory for temporary files
+	 */
+	size_t mem_limit;
+	std::string tmp_dir;
+	/*
+	 * segments waiting for being sorted and written as a run
+	 */
+	std::vector<Record> buffer;
+	size_t buffer_capacity;
+	/*
+	 * files holding sorted runs of segments
+	 */
+	std::vector<FILE*> runs;
+	/*
+	 * file and buffer holding pairs of crossing segments
+	 */
+	std::string pairs_path;
+	FILE *pairs_file;
+	std::vector<std::pair<long long, long long> > pairs;
+	size_t pairs_capacity;
+	/*
+	 * indicate writing one of runs failed or memory limit was exceeded
+	 */
+	bool write_failed;
+	bool exceeded_memory;
+	/*
+	 * paths of every created temporary file, removed by destructor
+	 */
+	std::vector<std::string> paths;
+	/*
+	 * range of y coordinates and total height of added segments, used for dividing opened segments into bands
+	 */
+	double min_y, max_y;
+	double sum_height;
+	/*
+	 * opened segments and their components
+	 */
+	BandedSweep sweeper;
+	/*
+	 * statistics of solving
+	 */
+	long long segments_count;
+	size_t max_opened_bytes;
+};
+
+#endif
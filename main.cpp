@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <random>
 #include <vector>
 #include <queue>
@@ -26,12 +27,19 @@
 #include <list>
 #include <iterator>
 #include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 
 
 #include "planarIntersections.h"
+#include "externalSweep.h"
+#include "streamSweep.h"
+#include "batch.h"
+#include "server.h"
 
 #include <boost/program_options.hpp>
 
@@ -61,6 +69,147 @@ void solveRandomizedTests(PlanarIntersections& test, double size, int number, in
 	for( int i = 0; i < iterations; ++i )
 		std::cout<<std::setw(12)<<solving_times[i]<<std::setw(12)<<complexities[i]<<std::setw(12)<<solving_times[i] * complexity_median / ( solve_median * complexities[i] ) << std::endl;
 }
+/*
+ * run every solver on the same growing data as randomized tests and measure its seconds per operation
+ * median of measured factors is written to given file, so --auto can predict time of solvers on this machine
+ */
+void calibrateSolvers(PlanarIntersections& test, double size, int number, int leng, int iterations, const std::string& path)
+{
+	Solvers intersection_solvers[] = { OTTMAN, NAIVE, SORTED_NAIVE, BALABAN, TRAPEZOID, QUADTREE };
+	Solvers graph_solvers[] = { BFS_GRAPH, DISJOINT_SET };
+	std::vector<std::vector<double> > factors( QUADTREE + 1 );
+	//graph solvers are measured on lists of neighbours, bit matrix would replace them
+	test.setAdjacencyStructure( LIST_ADJACENCY );
+	double step_size = size;
+	int step_number = number;
+	for( int i = 0; i < iterations; ++i )
+	{
+		test.setMax( step_size );
+		test.generateSegments( step_number, leng );
+		DensityProbe probe = test.probeDensity();
+
+		//intersection solvers only count crossings, so connecting segments is left for graph solvers
+		test.setCountOnly( true );
+		for( Solvers s : intersection_solvers )
+		{
+			test.setIntersectionSolver( s );
+			double time = test.solveWithTime();
+			if( time > 0 )
+				factors[s].push_back( time / PlanarIntersections::costModel( s, probe ) );
+		}
+
+		//graph solver takes the rest of full solving, segments are generated again as they keep their neighbours
+		test.setIntersectionSolver( OTTMAN );
+		for( Solvers s : graph_solvers )
+		{
+			test.generateSegments( step_number, leng );
+			test.setCountOnly( true );
+			double counting = test.solveWithTime();
+			test.setCountOnly( false );
+			test.setGraphSolver( s );
+			double time = test.solveWithTime() - counting;
+			probe.intersections = test.getIntersectionsCount();
+			if( counting >= 0 && time > 0 )
+				factors[s].push_back( time / PlanarIntersections::costModel( s, probe ) );
+		}
+		step_size += size * 0.3;
+		step_number += number;
+	}
+
+	std::cout<<std::setw(16)<<"solver"<<std::setw(16)<<"cost factor"<<std::endl;
+	for( int s = 0; s <= QUADTREE; ++s )
+	{
+		if( factors[s].empty() )
+			continue;
+		std::sort( factors[s].begin(), factors[s].end() );
+		test.setCostFactor( (Solvers)s, factors[s][ factors[s].size() / 2 ] );
+		std::cout<<std::setw(16)<<PlanarIntersections::solverName( (Solvers)s )<<std::setw(16)<<test.getCostFactor( (Solvers)s )<<std::endl;
+	}
+
+	std::ofstream out( path );
+	if( !out ) {
+		std::cout<<"Couldn't write cost factors to "<<path<<std::endl;
+		return;
+	}
+	test.writeCostFactors( out );
+}
+
+/*
+ * solve degenerate inputs with every intersection solver and compare numbers of intersections with naive algorithm
+ * return false if any solver differs from it or fails
+ */
+bool checkSolvers()
+{
+	typedef std::vector<std::vector<double> > Input;
+	std::vector<std::pair<std::string, Input> > inputs;
+	const double pi = acos( -1 );
+
+	//crossing of two segments is computed a little before vertical segment passing through it
+	inputs.push_back( std::make_pair( "vertical through crossing", Input{ { 500, 100, 500, 900 },
+			{ 735.1141009169892, 176.39320225002103, 264.8858990830108, 823.606797749979 },
+			{ 880.4226065180615, 376.393202250021, 119.5773934819386, 623.606797749979 } } ) );
+
+	//many segments crossing in one point, also with vertical and horizontal one
+	Input star, cross;
+	for( int i = 0; i < 40; ++i )
+	{
+		double a = pi * i / 40;
+		star.push_back( { 500 + 400 * cos( a ), 500 + 400 * sin( a ), 500 - 400 * cos( a ), 500 - 400 * sin( a ) } );
+		a = pi * ( i + 0.5 ) / 40;
+		cross.push_back( { 500 + 300 * cos( a ), 500 + 300 * sin( a ), 500 - 300 * cos( a ), 500 - 300 * sin( a ) } );
+	}
+	cross.push_back( { 500, 100, 500, 900 } );
+	cross.push_back( { 100, 500, 900, 500 } );
+	inputs.push_back( std::make_pair( "star", star ) );
+	inputs.push_back( std::make_pair( "star with axes", cross ) );
+
+	//diagonals pass through crossings of grid, chain touches itself and grid in ending points
+	Input grid;
+	for( int i = 0; i <= 15; ++i )
+	{
+		grid.push_back( { 0, i * 20.0, 300, i * 20.0 } );
+		grid.push_back( { i * 20.0, 0, i * 20.0, 300 } );
+		grid.push_back( { 0, i * 20.0, 300 - i * 20.0, 300 } );
+		grid.push_back( { i * 20.0, 300, i * 20.0 + 20, 280 } );
+	}
+	inputs.push_back( std::make_pair( "grid", grid ) );
+
+	Solvers solvers[] = { OTTMAN, SORTED_NAIVE, BALABAN, TRAPEZOID, QUADTREE };
+	bool agree = true;
+	for( auto& input : inputs )
+	{
+		PlanarIntersections test;
+		test.reset();
+		for( auto& s : input.second )
+			test.addSegment( s[0], s[1], s[2], s[3] );
+		test.setCountOnly( true );
+		test.setIntersectionSolver( NAIVE );
+		test.solve();
+		long long expected = test.getIntersectionsCount();
+		std::cout<<std::setw(28)<<input.first<<std::setw(8)<<expected;
+
+		//Ottman-Bentley algorithm is checked with both status structures
+		bool same = true;
+		for( Solvers s : solvers )
+		{
+			for( StatusStructures status : { TREE_STATUS, BLOCKED_STATUS } )
+			{
+				if( s != OTTMAN && status == BLOCKED_STATUS )
+					continue;
+				test.setIntersectionSolver( s );
+				test.setStatusStructure( status );
+				if( !test.solve() || test.getIntersectionsCount() != expected ) {
+					std::cout<<"  "<<PlanarIntersections::solverName( s )<<( status == BLOCKED_STATUS ? " with blocked status" : "" )<<" found "<<test.getIntersectionsCount();
+					same = false;
+				}
+			}
+		}
+		std::cout<<( same ? "  ok" : "" )<<std::endl;
+		agree = agree && same;
+	}
+	return agree;
+}
+
 /* 
  * main function, parses command line arguments and solves a task
  * */
@@ -85,12 +234,43 @@ int main(int ac, char *av[])
 			("random", 		po::value<int>(),		"make specified number of tests with random data, each one with more segments and bigger plane")
 			("visualize,v",							"show visualization of segments")
 			("draw_squares",						"draw square on each intersection")
+			("render",		po::value<std::string>(),	"draw segments to given image file without opening a window, format is chosen by extension")
+			("render_size",	po::value<unsigned int>(),	"size of longer side of rendered image in pixels")
 			("ottman_bentley", 						"use Ottman-Bentley algorithm")
 			("naive",								"use naive algorithm")
 			("naive_sorted",						"use naive pre-sorted algorithm")
+			("balaban",								"use Balaban algorithm, its time depends on number of intersections")
+			("trapezoid",							"use randomized trapezoidal map, it is kept for point queries")
+			("quadtree",							"use adaptive quadtree searching its leaves in parallel, good for clustered data")
+			("blocked_status",						"keep segments crossing sweep line of Ottman-Bentley algorithm in sorted blocks instead of red-black tree")
+			("bit_matrix",							"keep crossing segments in bit matrix and find components by searching its rows, with --auto chosen for dense segments found by BFS")
+			("adjacency_lists",						"keep crossing segments in lists of neighbours, used by default")
+			("auto",								"choose intersection and graph solvers predicted to be the fastest for given segments")
+			("calibration", po::value<std::string>(),	"read cost factors of solvers used by --auto from given file")
+			("calibrate", po::value<std::string>(),	"measure cost factors of solvers on randomized tests and write them to given file, --random gives number of tests")
+			("check",								"compare number of intersections found by every solver with naive algorithm on degenerate inputs")
 			("BFS",									"use BFS algorithm")
 			("disjoint_set",						"use disjoint-set algorithm")
+			("polylines",							"read polylines instead of segments, touching of neighbouring edges in shared vertex is not reported")
+			("layers",								"read layer of every segment as fifth value, report only crossings of different layers")
+			("layer_pairs", po::value<std::vector<int> >()->multitoken(),	"report only crossings of given pairs of layers: a1 b1 a2 b2 ...")
+			("mem-limit", 	po::value<double>(),	"solve segments not fitting into memory using no more than given number of megabytes, temporary files are written to TMPDIR")
+			("stream",								"sweep segments data from standard input sorted by smaller x coordinate of segments, only segments crossing sweep line are kept in memory")
+			("stream_pairs", po::value<std::string>(),	"write pairs of crossing segments found by --stream, --mem-limit or --count to given file as they are found")
+			("any",									"only check whether any two segments intersect, stop at first crossing")
+			("batch", po::value<std::string>(),		"solve every file listed in given manifest, one path in every line, results are printed in order of manifest")
+			("batch_stream",						"solve instances given one after another in segments data format on standard input")
+			("serve", po::value<std::string>(),		"run server keeping sets of segments and answering requests of clients on Unix domain socket of given path")
+			("threads", po::value<int>(),			"number of threads solving instances of batch or serving clients, by default number of hardware threads")
+			("snap-distance", po::value<double>(),	"connect segments lying no further than given distance from each other, gaps are not counted as intersections")
+			("count",								"only count intersections, don't store them nor search connected components")
 			("dense",								"indicate data will be hard, complexity of algorithms might change")
+			("query_segment", po::value<std::vector<double> >()->multitoken(),	"after solving print segments crossing segment x1 y1 x2 y2, can be given many times")
+			("query_window", po::value<std::vector<double> >()->multitoken(),	"after solving print segments lying in rectangle x1 y1 x2 y2, can be given many times")
+			("components",							"after solving print size, bounding box and total length of every connected component")
+			("connected", po::value<std::vector<int> >()->multitoken(),	"after solving print whether segments of given numbers are connected: a1 b1 a2 b2 ...")
+			("query_point", po::value<std::vector<double> >()->multitoken(),	"after solving with trapezoidal map print segments directly above and below point x y, can be given many times")
+			("arrangement", po::value<std::string>(),	"write arrangement of segments as doubly-connected edge list to given file, it is built by Ottman-Bentley algorithm")
 		;
 
 		po::store(po::parse_command_line(ac, av, desc), vm);
@@ -129,24 +309,170 @@ int main(int ac, char *av[])
 		test.setDenseData(true);
 	}
 
+	//compare solvers on degenerate inputs, exit status tells whether they agree
+	if( vm.count("check") ) {
+		return checkSolvers() ? 0 : 1;
+	}
+
+	//measure solvers on randomized tests
+	if( vm.count("calibrate") ) {
+		int iterations = vm.count("random") ? vm["random"].as<int>() : 5;
+		calibrateSolvers( test, size, number, leng, iterations, vm["calibrate"].as<std::string>() );
+		return 0;
+	}
+
+	//sweep presorted segments as they are read, nothing is kept after sweep line passes it
+	if( vm.count("stream") ) {
+		StreamSweep sweep;
+		std::ofstream pairs;
+		if( vm.count("stream_pairs") ) {
+			pairs.open( vm["stream_pairs"].as<std::string>() );
+			if( !pairs ) {
+				std::cout<<"Couldn't write pairs to "<<vm["stream_pairs"].as<std::string>()<<std::endl;
+				return 0;
+			}
+			sweep.setReporter( [&]( long long a, long long b, double, double ) { pairs<<a<<" "<<b<<"\n"; } );
+		}
+
+		clock_t tStart = clock();
+		long long count;
+		std::cin>>count;
+		for( long long i = 0; i < count; ++i )
+		{
+			double x1, y1, x2, y2;
+			if( !( std::cin>>x1>>y1>>x2>>y2 ) ) {
+				std::cout<<"Couldn't read segment "<<i<<std::endl;
+				return 0;
+			}
+			if( !sweep.addSegment( x1, y1, x2, y2 ) ) {
+				std::cout<<"Segment "<<i<<" begins before previous one, segments have to be sorted by smaller x coordinate"<<std::endl;
+				return 0;
+			}
+		}
+		sweep.finish();
+		std::cout<<"Band height: "<<sweep.getBandHeight()<<" Maximal opened segments: "<<sweep.getMaxOpened()<<std::endl;
+		std::cout<<"Intersections: "<<sweep.getIntersectionsCount()<<" Connected components: "<<sweep.getComponentsCount()<<std::endl;
+		std::cout<<"Time taken: "<<(double)(clock() - tStart)/CLOCKS_PER_SEC<<std::endl;
+		return 0;
+	}
+
+	//solve out of memory, segments are streamed into temporary files instead of being loaded
+	if( vm.count("mem-limit") ) {
+		const char *tmp_dir = getenv("TMPDIR");
+		ExternalSweep sweep( vm["mem-limit"].as<double>() * 1024 * 1024, tmp_dir != nullptr ? tmp_dir : "/tmp" );
+		if( vm.count("stream_pairs") ) {
+			sweep.setPairsPath( vm["stream_pairs"].as<std::string>() );
+		}
+		if( vm.count("read") ) {
+			std::cout<<"Specify number of segments"<<std::endl;
+			std::cin>>number;
+			std::cout<<"Write segments data: x1 y1 x2 y2"<<std::endl;
+		}
+		for( int i = 0; i < number; ++i )
+		{
+			double x1, y1, x2, y2;
+			if( vm.count("read") ) {
+				std::cin>>x1>>y1>>x2>>y2;
+			}
+			else {
+				Segment::generateLengthCoordinates( test.getMin(), test.getMax(), leng, x1, y1, x2, y2 );
+			}
+			sweep.addSegment( x1, y1, x2, y2 );
+		}
+
+		clock_t tStart = clock();
+		if( !sweep.solve() ) {
+			if( sweep.exceededMemory() )
+				std::cout<<"Segments crossing sweep line don't fit into memory limit, "<<sweep.getMaxOpened()<<" segments were opened"<<std::endl;
+			else
+				std::cout<<"Couldn't write temporary files"<<std::endl;
+			return 0;
+		}
+		std::cout<<"Sorted runs: "<<sweep.getRunsCount()<<" Maximal opened segments: "<<sweep.getMaxOpened()<<" taking "<<sweep.getMaxOpenedBytes()<<" bytes"<<std::endl;
+		std::cout<<"Intersections: "<<sweep.getIntersectionsCount()<<" Connected components: "<<sweep.getComponentsCount()<<std::endl;
+		std::cout<<"Time taken: "<<(double)(clock() - tStart)/CLOCKS_PER_SEC<<std::endl;
+		return 0;
+	}
+
+	//instances of batch are read by batch solver, segments of server are sent by its clients
+	bool batch = vm.count("batch") || vm.count("batch_stream") || vm.count("serve");
+
+	//read polylines from input, every one is given by number of its points, whether it is closed and its points
+	if( !batch && vm.count("read") && vm.count("polylines") ) {
+		std::cout<<"Specify number of polylines"<<std::endl;
+		std::cin>>number;
+		if( vm.count("layers") ) {
+			std::cout<<"Write polylines data: points closed layer x1 y1 x2 y2 ..."<<std::endl;
+		}
+		else {
+			std::cout<<"Write polylines data: points closed x1 y1 x2 y2 ..."<<std::endl;
+		}
+		for( int i = 0; i < number; ++i )
+		{
+			int points = 0, closed = 0, layer = 0;
+			std::cin>>points>>closed;
+			if( vm.count("layers") ) {
+				std::cin>>layer;
+				if( layer < 0 || layer >= PlanarIntersections::MAX_LAYERS ) {
+					std::cout<<"Layer has to be number from 0 to "<<PlanarIntersections::MAX_LAYERS - 1<<std::endl;
+					return 0;
+				}
+			}
+			std::vector<double> coordinates( 2 * std::max( points, 0 ) );
+			for( auto& c : coordinates )
+				std::cin>>c;
+			test.addPolyline( coordinates, closed != 0, layer );
+		}
+	}
 	//read segments from input
-	if( vm.count("read") ) {
+	else if( !batch && vm.count("read") ) {
 		std::cout<<"Specify number of segments"<<std::endl;
 		std::cin>>number;
-		std::cout<<"Write segments data: x1 y1 x2 y2"<<std::endl;
+		if( vm.count("layers") ) {
+			std::cout<<"Write segments data: x1 y1 x2 y2 layer"<<std::endl;
+		}
+		else {
+			std::cout<<"Write segments data: x1 y1 x2 y2"<<std::endl;
+		}
 		for( int i = 0; i < number; ++i )
 		{
 			double x1, y1, x2, y2;
+			int layer = 0;
 			std::cin>>x1>>y1>>x2>>y2;
-			test.addSegment( x1, y1, x2, y2 );
+			if( vm.count("layers") ) {
+				std::cin>>layer;
+				if( layer < 0 || layer >= PlanarIntersections::MAX_LAYERS ) {
+					std::cout<<"Layer has to be number from 0 to "<<PlanarIntersections::MAX_LAYERS - 1<<std::endl;
+					return 0;
+				}
+			}
+			test.addSegment( x1, y1, x2, y2, layer );
 		}
 	}
-	else {
+	else if( !batch ) {
 		test.generateSegments( number, leng );
 	}
 
 	//set solver for intersections
-	if( vm.count("ottman_bentley") ) {
+	//automatic choice probes segments, so it is made after they are read
+	if( vm.count("auto") ) {
+		if( vm.count("calibration") ) {
+			std::ifstream in( vm["calibration"].as<std::string>() );
+			if( !in || !test.readCostFactors( in ) ) {
+				std::cout<<"Couldn't read cost factors from "<<vm["calibration"].as<std::string>()<<", default ones are used"<<std::endl;
+			}
+		}
+		test.setBuildArrangement( vm.count("arrangement") > 0 );
+		if( batch ) {
+			std::cout<<"Solvers are chosen for every instance of batch or set of server."<<std::endl;
+		}
+		else {
+			DensityProbe probe = test.chooseSolvers();
+			std::cout<<"Estimated intersections: "<<probe.intersections<<" Segments crossing sweep line: "<<probe.active<<std::endl;
+			std::cout<<"Chosen "<<PlanarIntersections::solverName( test.getIntersectionSolver() )<<" for solving intersections."<<std::endl;
+		}
+	}
+	else if( vm.count("ottman_bentley") ) {
 		test.setIntersectionSolver( OTTMAN );
 		std::cout<<"Chosen Ottman-Bentley algorithm for solving intersections."<<std::endl;
 	}
@@ -154,13 +480,64 @@ int main(int ac, char *av[])
 		test.setIntersectionSolver( SORTED_NAIVE );
 		std::cout<<"Chosen naive pre-sorted algorithm for solving intersections."<<std::endl;
 	}
+	else if( vm.count("balaban") ) {
+		test.setIntersectionSolver( BALABAN );
+		std::cout<<"Chosen Balaban algorithm for solving intersections."<<std::endl;
+	}
+	else if( vm.count("trapezoid") ) {
+		test.setIntersectionSolver( TRAPEZOID );
+		std::cout<<"Chosen trapezoidal map for solving intersections."<<std::endl;
+	}
+	else if( vm.count("quadtree") ) {
+		test.setIntersectionSolver( QUADTREE );
+		std::cout<<"Chosen adaptive quadtree for solving intersections."<<std::endl;
+	}
 	else {
 		test.setIntersectionSolver( NAIVE );
 		std::cout<<"Chosen naive algorithm for solving intersections."<<std::endl;
 	}
 
+	//arrangement is built while sweeping
+	if( vm.count("arrangement") ) {
+		if( test.getIntersectionSolver() != OTTMAN ) {
+			test.setIntersectionSolver( OTTMAN );
+			std::cout<<"Arrangement is built by Ottman-Bentley algorithm, it is used for solving intersections instead."<<std::endl;
+		}
+		test.setBuildArrangement( true );
+	}
+
+	//set structure used by Ottman-Bentley algorithm
+	if( vm.count("blocked_status") ) {
+		test.setStatusStructure( BLOCKED_STATUS );
+	}
+
+	//set structure keeping crossing segments, matrix is searched in place of graph solver
+	if( vm.count("bit_matrix") && vm.count("disjoint_set") ) {
+		std::cout<<"Components of bit matrix are found by searching its rows, it can't be used with --disjoint_set"<<std::endl;
+		return 0;
+	}
+	if( vm.count("bit_matrix") ) {
+		test.setAdjacencyStructure( MATRIX_ADJACENCY );
+	}
+	else if( vm.count("adjacency_lists") ) {
+		test.setAdjacencyStructure( LIST_ADJACENCY );
+	}
+	else if( vm.count("auto") ) {
+		test.setAdjacencyStructure( AUTO_ADJACENCY );
+	}
+
+	//gaps between segments are joined only by disjoint-sets
+	if( vm.count("snap-distance") && vm.count("BFS") ) {
+		std::cout<<"Segments can't be snapped when components are found with BFS, use --disjoint_set instead"<<std::endl;
+		return 0;
+	}
+
 	//set solver for graphs
-	if( vm.count("disjoint_set") ) {
+	if( vm.count("auto") ) {
+		if( !batch )
+			std::cout<<"Chosen "<<PlanarIntersections::solverName( test.getGraphSolver() )<<" for solving graph algorithm."<<std::endl;
+	}
+	else if( vm.count("disjoint_set") || vm.count("snap-distance") ) {
 		test.setGraphSolver( DISJOINT_SET );
 		std::cout<<"Chosen disjoint-sets for solving graph algorithm."<<std::endl;
 	}
@@ -169,12 +546,112 @@ int main(int ac, char *av[])
 		std::cout<<"Chosen BFS for solving graph algorithm."<<std::endl;
 	}
 
+	//report only crossings of chosen layers
+	if( vm.count("layers") || vm.count("layer_pairs") ) {
+		std::vector<std::pair<int, int> > pairs;
+		if( vm.count("layer_pairs") ) {
+			auto& layers = vm["layer_pairs"].as<std::vector<int> >();
+			for( unsigned int i = 0; i + 1 < layers.size(); i += 2 )
+			{
+				if( layers[i] < 0 || layers[i] >= PlanarIntersections::MAX_LAYERS || layers[i+1] < 0 || layers[i+1] >= PlanarIntersections::MAX_LAYERS ) {
+					std::cout<<"Layer has to be number from 0 to "<<PlanarIntersections::MAX_LAYERS - 1<<std::endl;
+					return 0;
+				}
+				pairs.push_back( std::make_pair( layers[i], layers[i+1] ) );
+			}
+		}
+		test.setLayerPairs( pairs );
+	}
+
+	//set drawing squares on visualization, intersections have to be recorded while solving
+	if( vm.count("draw_squares") ) {
+		test.setDrawSquares( true );
+	}
+
+	//connect segments missing each other by small gaps
+	if( vm.count("snap-distance") ) {
+		test.setSnapDistance( vm["snap-distance"].as<double>() );
+		std::cout<<"Segments closer than "<<test.getSnapDistance()<<" are connected, components are found with disjoint-sets."<<std::endl;
+	}
+
+	//only count intersections
+	if( vm.count("count") ) {
+		test.setCountOnly( true );
+	}
+
+	//serve clients until one of them asks for shutdown, every set of segments copies configured solver
+	if( vm.count("serve") ) {
+		SolverServer server( test, vm.count("threads") ? vm["threads"].as<int>() : 0 );
+		server.setChooseSolvers( vm.count("auto") > 0 );
+		std::cout<<"Serving on "<<vm["serve"].as<std::string>()<<std::endl;
+		if( !server.serve( vm["serve"].as<std::string>() ) ) {
+			std::cout<<"Couldn't listen on "<<vm["serve"].as<std::string>()<<std::endl;
+			return 0;
+		}
+		std::cout<<"Served requests: "<<server.getRequestsCount()<<std::endl;
+		return 0;
+	}
+
+	//solve many instances on pool of threads, every thread copies configured solver
+	if( batch ) {
+		BatchSolver solver( test, vm.count("threads") ? vm["threads"].as<int>() : 0 );
+		solver.setChooseSolvers( vm.count("auto") > 0 );
+		auto start = std::chrono::steady_clock::now();
+		if( vm.count("batch") ) {
+			std::ifstream manifest( vm["batch"].as<std::string>() );
+			if( !manifest ) {
+				std::cout<<"Couldn't read manifest "<<vm["batch"].as<std::string>()<<std::endl;
+				return 0;
+			}
+			solver.solveManifest( manifest, std::cout );
+		}
+		else {
+			solver.solveStream( std::cin, std::cout );
+		}
+		double time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+		std::cout<<"Solved instances: "<<solver.getSolvedCount()<<" Failed: "<<solver.getFailedCount()<<std::endl;
+		std::cout<<"Time taken: "<<time<<std::endl;
+		return 0;
+	}
+
+	//only test whether there is any intersection
+	if( vm.count("any") ) {
+		clock_t tStart = clock();
+		bool found = test.anyIntersection();
+		double time = (double)(clock() - tStart)/CLOCKS_PER_SEC;
+		if( found ) {
+			std::cout<<"Segments intersect: "<<test.getFirstIntersection().first<<" and "<<test.getFirstIntersection().second<<std::endl;
+		}
+		else {
+			std::cout<<"No segments intersect"<<std::endl;
+		}
+		std::cout<<"Time taken: "<<time<<std::endl;
+		return 0;
+	}
+
 	//create random data and test program
 	//creating more segments in each step
 	if( vm.count("random") ) {
 		int iterations = vm["random"].as<int>();
 		solveRandomizedTests(test, size, number, leng, iterations );
 	}
+	//count intersections writing every one as solver finds it, nothing is stored
+	else if( test.countOnly() && vm.count("stream_pairs") ) {
+		std::ofstream pairs( vm["stream_pairs"].as<std::string>() );
+		if( !pairs ) {
+			std::cout<<"Couldn't write pairs to "<<vm["stream_pairs"].as<std::string>()<<std::endl;
+			return 0;
+		}
+		auto write = [&]( int a, int b, double, double ) { pairs<<a<<" "<<b<<"\n"; };
+		clock_t tStart = clock();
+		if( !test.visitIntersections( write ) ) {
+			std::cout<<"Too much precision needed to finish calculations"<<std::endl;
+		}
+		else {
+			std::cout<<"Intersections: "<<test.getIntersectionsCount()<<std::endl;
+			std::cout<<"Time taken: "<<(double)(clock() - tStart)/CLOCKS_PER_SEC<<std::endl;
+		}
+	}
 	//else solve problem and prints its time
 	else {
 		double time = test.solveWithTime();
@@ -182,14 +659,115 @@ int main(int ac, char *av[])
 			std::cout<<"Too much precision needed to finish calculations"<<std::endl;
 		}
 		else {
+			if( test.countOnly() ) {
+				std::cout<<"Intersections: "<<test.getIntersectionsCount()<<std::endl;
+			}
+			if( test.getIntersectionSolver() == QUADTREE ) {
+				const QuadtreeStats& stats = test.getQuadtreeStats();
+				std::cout<<"Quadtree leaves: "<<stats.leaves<<" (brute force: "<<stats.brute_leaves<<", sweep: "<<stats.sweep_leaves<<")";
+				std::cout<<" Depth: "<<stats.depth<<" Segments in leaves: "<<stats.copies<<std::endl;
+			}
 			std::cout<<"Time taken: "<<time<<std::endl;
 		}
 	}
 
 
-	//set drawing squares on visualization
-	if( vm.count("draw_squares") ) {
-		test.setDrawSquares( true );
+	//answer queries about solved segments
+	if( vm.count("query_segment") || vm.count("query_window") ) {
+		std::vector<IndexQuery> queries;
+		const char *names[] = { "query_segment", "query_window" };
+		for( int t = 0; t < 2; ++t )
+		{
+			if( !vm.count(names[t]) ) continue;
+			auto& coords = vm[names[t]].as<std::vector<double> >();
+			for( unsigned int i = 0; i + 3 < coords.size(); i += 4 )
+			{
+				IndexQuery q = { t == 0 ? IndexQuery::SEGMENT : IndexQuery::WINDOW, coords[i], coords[i+1], coords[i+2], coords[i+3] };
+				queries.push_back( q );
+			}
+		}
+
+		test.buildIndex();
+		std::vector<std::vector<int> > results;
+		test.getIndex().batchQuery( queries, results );
+		for( unsigned int i = 0; i < queries.size(); ++i )
+		{
+			std::cout<<( queries[i].type == IndexQuery::SEGMENT ? "Segments crossing (" : "Segments in window (" );
+			std::cout<<queries[i].x1<<", "<<queries[i].y1<<", "<<queries[i].x2<<", "<<queries[i].y2<<"):";
+			std::sort( results[i].begin(), results[i].end() );
+			for( int index : results[i] )
+				std::cout<<" "<<index;
+			std::cout<<std::endl;
+		}
+	}
+
+	//answer queries about connected components
+	if( vm.count("components") || vm.count("connected") ) {
+		if( test.countOnly() ) {
+			std::cout<<"Components are not searched when only counting intersections"<<std::endl;
+		}
+		else {
+			test.buildComponentIndex();
+			const ComponentIndex& index = test.getComponentIndex();
+			if( vm.count("components") ) {
+				std::cout<<"Connected components: "<<index.getComponentsCount()<<std::endl;
+				for( int c = 0; c < index.getComponentsCount(); ++c )
+				{
+					const ComponentStats& st = index.getStats( c );
+					std::cout<<"Component "<<c<<": segments "<<st.size<<" box ("<<st.min_x<<", "<<st.min_y<<", "<<st.max_x<<", "<<st.max_y<<")";
+					std::cout<<" length "<<st.length<<" first segment "<<*index.membersBegin( c )<<std::endl;
+				}
+			}
+			if( vm.count("connected") ) {
+				auto& numbers = vm["connected"].as<std::vector<int> >();
+				int n = test.getSegments().size();
+				for( unsigned int i = 0; i + 1 < numbers.size(); i += 2 )
+				{
+					if( numbers[i] < 0 || numbers[i] >= n || numbers[i+1] < 0 || numbers[i+1] >= n ) {
+						std::cout<<"Segment has to be number from 0 to "<<n - 1<<std::endl;
+						continue;
+					}
+					std::cout<<"Segments "<<numbers[i]<<" and "<<numbers[i+1]<<( index.connected( numbers[i], numbers[i+1] ) ? " are" : " are not" )<<" connected"<<std::endl;
+				}
+			}
+		}
+	}
+
+	//locate points in trapezoidal map built while solving
+	if( vm.count("query_point") ) {
+		if( test.getIntersectionSolver() != TRAPEZOID ) {
+			std::cout<<"Point queries need trapezoidal map, choose it with --trapezoid"<<std::endl;
+		}
+		else {
+			auto& coords = vm["query_point"].as<std::vector<double> >();
+			for( unsigned int i = 0; i + 1 < coords.size(); i += 2 )
+			{
+				int above, below;
+				test.getTrapezoidMap().locate( coords[i], coords[i+1], above, below );
+				std::cout<<"Segments around ("<<coords[i]<<", "<<coords[i+1]<<"): above "<<above<<", below "<<below<<std::endl;
+			}
+		}
+	}
+
+	//write arrangement built while solving
+	if( vm.count("arrangement") && !vm.count("random") ) {
+		std::ofstream out( vm["arrangement"].as<std::string>() );
+		if( !out ) {
+			std::cout<<"Couldn't write arrangement to "<<vm["arrangement"].as<std::string>()<<std::endl;
+		}
+		else {
+			test.getArrangement().write( out );
+		}
+	}
+
+	//draw results to image file
+	if( vm.count("render") ) {
+		unsigned int render_size = 1000;
+		if( vm.count("render_size") ) {
+			render_size = vm["render_size"].as<unsigned int>();
+		}
+		if( !test.render( vm["render"].as<std::string>(), render_size ) )
+			std::cout<<"Couldn't save image "<<vm["render"].as<std::string>()<<std::endl;
 	}
 
 	//visualize results
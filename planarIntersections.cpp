@@ -19,68 +19,221 @@
 #include "planarIntersections.h"
 
 
-PlanarIntersections::PlanarIntersections() : min(0.0) , max(1000.0) , graph_solver(OTTMAN), intersection_solver(BFS_GRAPH), draw_squares(false), denseData(false) {}
+PlanarIntersections::PlanarIntersections() : quadtree_stats(), min(0.0) , max(1000.0) , graph_solver(OTTMAN), intersection_solver(BFS_GRAPH), status_structure(TREE_STATUS), adjacency_structure(LIST_ADJACENCY), matrix_adjacency(false), dense_graph(false), adjacency_words(0), draw_squares(false), denseData(false),
+	count_only(false), snap_distance(0), record_intersections(false), build_arrangement(false), intersections_count(0), use_layers(false), runs_count(0), disjoint_set(0),
+	visitor_call(nullptr), visitor_data(nullptr)
+{
+	//seconds per operation measured with --calibrate on randomized tests
+	static const double default_costs[] = { 7.1e-8, 2.4e-8, 3.2e-8, 2.2e-7, 1.8e-7, 1.8e-8, 3.8e-7, 7.5e-8 };
+	cost_factors.assign( default_costs, default_costs + QUADTREE + 1 );
+}
 
 
-void PlanarIntersections::generateSegments( int n, double length ) 
+void PlanarIntersections::reset()
 {
-	//clear previous segments
 	Segment::resetIndex();
-	segments.erase( segments.begin(), segments.end() );
-	squares.erase( squares.begin(), squares.end() );
+	for( auto& s : segments )
+		spare_segments.push_back( std::move( s ) );
+	segments.clear();
+	intersections.clear();
+	spatial_index.clear();
+	component_index.clear();
+	trapezoid_map.clear();
+	arrangement.clear();
+	chains.clear();
+	runs_count = 0;
+	intersections_count = 0;
+}
 
+void PlanarIntersections::reserve( int n )
+{
+	segments.reserve( n );
+	spare_segments.reserve( n );
+}
+
+Segment& PlanarIntersections::newSegment( double x1, double y1, double x2, double y2 )
+{
+	if( spare_segments.empty() ) {
+		segments.push_back( Segment(x1, y1, x2, y2) );
+	}
+	else {
+		segments.push_back( std::move( spare_segments.back() ) );
+		spare_segments.pop_back();
+		segments.back().assign( x1, y1, x2, y2 );
+	}
+	return segments.back();
+}
+
+void PlanarIntersections::generateSegments( int n, double length ) 
+{
+	//clear previous segments, their memory is used for new ones
+	reset();
+	segments.reserve( n );
+
+	double x1, y1, x2, y2;
 	for( int i = 0; i < n; ++i )
 	{
-		segments.push_back( Segment::generateLengthSegment( min, max, length ) );
+		Segment::generateLengthCoordinates( min, max, length, x1, y1, x2, y2 );
+		newSegment( x1, y1, x2, y2 );
 	}
 }
 
 void PlanarIntersections::addSegment( const Segment& s )
 {
-	segments.push_back( s );
+	if( spare_segments.empty() ) {
+		segments.push_back( s );
+	}
+	else {
+		segments.push_back( std::move( spare_segments.back() ) );
+		spare_segments.pop_back();
+		segments.back() = s;
+	}
 }
 
 void PlanarIntersections::addSegment( double x1, double y1, double x2, double y2)
 {
-	segments.push_back( Segment(x1, y1, x2, y2) );
+	newSegment( x1, y1, x2, y2 );
 }
 
-void PlanarIntersections::visualize()
+void PlanarIntersections::addSegment( double x1, double y1, double x2, double y2, int layer )
 {
-	sf::RenderWindow window(sf::VideoMode((int)max, (int)max), "Planar visualization");
+	newSegment( x1, y1, x2, y2 ).setLayer( layer );
+}
 
-	while(window.isOpen())
+void PlanarIntersections::addPolyline( const std::vector<double>& points, bool closed, int layer )
+{
+	//repeated points make no edges
+	std::vector<double> p;
+	for( unsigned int i = 0; i + 1 < points.size(); i += 2 )
 	{
-		sf::Event event;
-		while(window.pollEvent(event))
-		{
-			if(event.type == sf::Event::Closed)
-				window.close();
+		if( p.empty() || points[i] != p[ p.size() - 2 ] || points[i + 1] != p.back() ) {
+			p.push_back( points[i] );
+			p.push_back( points[i + 1] );
 		}
+	}
+	if( closed && p.size() > 4 && p[0] == p[ p.size() - 2 ] && p[1] == p.back() ) {
+		p.pop_back();
+		p.pop_back();
+	}
+	if( p.size() < 4 )
+		return;
+	if( closed && p.size() > 4 ) {
+		p.push_back( p[0] );
+		p.push_back( p[1] );
+	}
+
+	//run goes on as long as edges go in the same direction along x, vertical edge is run on its own
+	Chain c = { -1, -1, closed && p.size() > 6 };
+	int direction = 0;
+	for( unsigned int i = 0; i + 3 < p.size(); i += 2 )
+	{
+		int d = p[i + 2] > p[i] ? 1 : ( p[i + 2] < p[i] ? -1 : 0 );
+		if( d == 0 || d != direction )
+			++runs_count;
+		direction = d;
 
+		addSegment( p[i], p[i + 1], p[i + 2], p[i + 3], layer );
+		segments.back().setChain( chains.size(), runs_count - 1 );
+		if( c.first == -1 )
+			c.first = segments.back().getData()->number;
+		c.last = segments.back().getData()->number;
+	}
+	chains.push_back( c );
+}
 
-		window.clear();
-		for( auto& s : segments)
-		{
-			window.draw(s.getVertexes(), 2, sf::Lines);
-		}
-		
-		//test if squares should be drawn
-		if( draw_squares ) {
-			for(auto s : squares)
-			{
-				window.draw(s);
-			}
-		}
-		window.display();
+void PlanarIntersections::setLayerPairs( const std::vector<std::pair<int, int> >& pairs )
+{
+	use_layers = true;
+	layer_mask.assign( MAX_LAYERS, 0 );
+	if( pairs.empty() ) {
+		//every pair of different layers
+		for( int i = 0; i < MAX_LAYERS; ++i )
+			layer_mask[i] = ~( 1ULL << i );
+		return;
 	}
 
+	for( auto& p : pairs )
+	{
+		layer_mask[p.first] |= 1ULL << p.second;
+		layer_mask[p.second] |= 1ULL << p.first;
+	}
+}
+
+void PlanarIntersections::visualize()
+{
+	//markers are made from recorded intersections only when drawn
+	static const std::vector<Intersection> none;
+	Renderer renderer;
+	renderer.build( segments, draw_squares ? intersections : none );
+	renderer.show( (int)max, (int)max, draw_squares );
+}
 
+bool PlanarIntersections::render( const std::string& path, unsigned int size )
+{
+	static const std::vector<Intersection> none;
+	Renderer renderer;
+	return renderer.renderToFile( segments, draw_squares ? intersections : none, size, path );
+}
+
+void PlanarIntersections::buildIndex()
+{
+	spatial_index.build( segments );
+}
+
+void PlanarIntersections::buildComponentIndex()
+{
+	component_index.build( segments );
 }
 
 bool PlanarIntersections::solve()
 {
+	//dense graph is kept in bit matrix instead of lists of neighbours
+	matrix_adjacency = chooseMatrix();
+	if( matrix_adjacency ) {
+		adjacency_words = ( segments.size() + 63 ) / 64;
+		adjacency.assign( (size_t)adjacency_words * segments.size(), 0 );
+	}
+	else {
+		std::vector<unsigned long long>().swap( adjacency );
+	}
+
+	//only number of intersections is needed, crossings are counted and there is no graph to solve
+	if( count_only ) {
+		auto count = []( int, int, double, double ) {};
+		return visitIntersections( count );
+	}
+	IntersectionStorage storage = { *this };
+	if( !visitData( storage ) ) {
+		return false;
+	}
+
+	//choose solver for findind connected components
+	//segments close to each other are joined only by disjoint-sets
+	if( matrix_adjacency ) {
+		matrixBFS();
+	}
+	else if( graph_solver == BFS_GRAPH && snap_distance <= 0 ) {
+		BFS();
+	}
+	else {
+		disjointSetFind();
+	}
+	return true;
+}
+
+bool PlanarIntersections::findIntersections()
+{
+	intersections_count = 0;
+	intersections.clear();
+	//crossings found by previous solving are forgotten, memory of their lists is kept
+	for( auto& s : segments )
+	{
+		s.getNeighbours().clear();
+		s.setGroup( -1 );
+	}
+
 	//choose solver for finding intersections
+	//crossings of layers which are not reported are skipped by every solver when reporting
 	if( intersection_solver == OTTMAN ) {
 		if( !OttmanBentley() ) {
 			return false;
@@ -91,18 +244,25 @@ bool PlanarIntersections::solve()
 			return false;
 		}
 	}
-	else {
-		if( !naive() ) {
+	else if( intersection_solver == BALABAN ) {
+		if( !balaban() ) {
 			return false;
 		}
 	}
-
-	//choose solver for findind connected components
-	if( graph_solver == BFS_GRAPH ) {
-		BFS();
+	else if( intersection_solver == TRAPEZOID ) {
+		if( !trapezoids() ) {
+			return false;
+		}
+	}
+	else if( intersection_solver == QUADTREE ) {
+		if( !quadtree() ) {
+			return false;
+		}
 	}
 	else {
-		disjointSetFind();
+		if( !naive() ) {
+			return false;
+		}
 	}
 	return true;
 }
@@ -118,6 +278,15 @@ double PlanarIntersections::solveWithTime()
 	return ((double)(clock() - tStart)/CLOCKS_PER_SEC);
 }
 
+int PlanarIntersections::countComponents() const
+{
+	std::vector<int> groups;
+	for( auto& s : segments )
+		groups.push_back( s.getGroup() );
+	std::sort( groups.begin(), groups.end() );
+	return std::unique( groups.begin(), groups.end() ) - groups.begin();
+}
+
 void PlanarIntersections::printResults() const
 {
 	for( auto& s : segments )
@@ -126,6 +295,16 @@ void PlanarIntersections::printResults() const
 
 double PlanarIntersections::getComplexity( int n )
 {
+	//Balaban's algorithm depends on number of found intersections instead of kind of data
+	if( intersection_solver == BALABAN )
+		return (double)n * log2(n) * log2(n) + intersections_count;
+	//every segment and crossing of trapezoidal map is found through search structure
+	if( intersection_solver == TRAPEZOID )
+		return ( (double)n + intersections_count ) * log2(n);
+	//leaves of quadtree hold bounded number of segments, unless they are too long to be divided
+	if( intersection_solver == QUADTREE )
+		return (double)n * log2(n) + intersections_count;
+
 	if( denseData ) {
 		if( intersection_solver == OTTMAN )
 			return ( (double) n * (double)n * log2(n));
@@ -141,13 +320,199 @@ double PlanarIntersections::getComplexity( int n )
 }
 
 
-void PlanarIntersections::addSquare(int x, int y)
+bool PlanarIntersections::chainReported( int s1, int s2 ) const
+{
+	const SegmentData *a = segments[s1].getData(), *b = segments[s2].getData();
+	if( a->chain == -1 || a->chain != b->chain )
+		return true;
+	//edges of one x-monotone run touch only in shared vertices
+	if( a->run == b->run )
+		return false;
+
+	const Chain& c = chains[ a->chain ];
+	int low = std::min( a->number, b->number ), high = std::max( a->number, b->number );
+	if( high - low != 1 && !( c.closed && low == c.first && high == c.last ) )
+		return true;
+
+	//neighbouring edges always touch in their shared vertex, they cross only if they go back over each other
+	double vx = a->x1, vy = a->y1, ax = a->x2, ay = a->y2;
+	if( ( a->x2 == b->x1 && a->y2 == b->y1 ) || ( a->x2 == b->x2 && a->y2 == b->y2 ) ) {
+		std::swap( vx, ax );
+		std::swap( vy, ay );
+	}
+	double bx = b->x1 == vx && b->y1 == vy ? b->x2 : b->x1;
+	double by = b->x1 == vx && b->y1 == vy ? b->y2 : b->y1;
+	return ( ax - vx ) * ( by - vy ) - ( ay - vy ) * ( bx - vx ) == 0 && ( ax - vx ) * ( bx - vx ) + ( ay - vy ) * ( by - vy ) > 0;
+}
+
+void PlanarIntersections::chainNeighbours( const SegmentData *d, int& before, int& after ) const
+{
+	before = after = -1;
+	if( d->chain == -1 )
+		return;
+	const Chain& c = chains[ d->chain ];
+	if( d->number > c.first )
+		before = d->number - 1;
+	else if( c.closed )
+		before = c.last;
+	if( d->number < c.last )
+		after = d->number + 1;
+	else if( c.closed )
+		after = c.first;
+}
+
+void PlanarIntersections::dataByNumber( std::vector<SegmentData*>& numbered ) const
+{
+	//data moves between segments while sweeping, so edges of polylines are found by their numbers
+	numbered.clear();
+	if( chains.empty() )
+		return;
+	for( auto& s : segments )
+	{
+		if( s.getData()->number >= (int)numbered.size() )
+			numbered.resize( s.getData()->number + 1, nullptr );
+		numbered[ s.getData()->number ] = s.getData();
+	}
+}
+DensityProbe PlanarIntersections::probeDensity( int sample ) const
+{
+	DensityProbe p = { (int)segments.size(), 0, 0 };
+	int n = segments.size();
+	if( n < 2 )
+		return p;
+
+	//width of segments along sweep line is cheap to get from every segment
+	double min_x = segments[0].getData()->x1, max_x = segments[0].getData()->x2, width = 0;
+	for( auto& s : segments )
+	{
+		min_x = std::min( min_x, s.getData()->x1 );
+		max_x = std::max( max_x, s.getData()->x2 );
+		width += s.getData()->x2 - s.getData()->x1;
+	}
+	p.active = max_x > min_x ? std::max( 1.0, std::min( (double)n, width / ( max_x - min_x ) ) ) : n;
+
+	//crossings are counted among sampled segments, sample is the same every time for the same number of segments
+	std::vector<int> chosen( n );
+	for( int i = 0; i < n; ++i )
+		chosen[i] = i;
+	int m = std::max( 2, std::min( n, sample ) );
+	std::default_random_engine engine( n );
+	for( int i = 0; i < m; ++i )
+		std::swap( chosen[i], chosen[ std::uniform_int_distribution<int>( i, n - 1 )( engine ) ] );
+
+	long long found = 0;
+	double x, y;
+	for( int i = 0; i < m; ++i )
+	{
+		const SegmentData *a = segments[ chosen[i] ].getData();
+		for( int j = i + 1; j < m; ++j )
+		{
+			const SegmentData *b = segments[ chosen[j] ].getData();
+			if( a->x2 < b->x1 || b->x2 < a->x1 || std::max( a->y1, a->y2 ) < std::min( b->y1, b->y2 ) || std::max( b->y1, b->y2 ) < std::min( a->y1, a->y2 ) )
+				continue;
+			if( segments[ chosen[i] ].intersects( segments[ chosen[j] ], x, y ) )
+				++found;
+		}
+	}
+	p.intersections = (double)found * ( (double)n * ( n - 1 ) ) / ( (double)m * ( m - 1 ) );
+	return p;
+}
+
+double PlanarIntersections::costModel( Solvers s, const DensityProbe& p )
+{
+	double n = std::max( p.segments, 2 ), k = p.intersections;
+	if( s == NAIVE )
+		return n * n / 2;
+	//every beginning is compared with segments crossing sweep line
+	if( s == SORTED_NAIVE )
+		return n * log2(n) + n * p.active;
+	if( s == OTTMAN || s == TRAPEZOID )
+		return ( n + k ) * log2(n);
+	if( s == BALABAN )
+		return n * log2(n) * log2(n) + k;
+	if( s == QUADTREE )
+		return n * log2(n) + k;
+	//graph solvers visit every segment and every found crossing
+	return n + k;
+}
+
+const char *PlanarIntersections::solverName( Solvers s )
+{
+	static const char *names[] = { "ottman_bentley", "naive", "naive_sorted", "BFS", "disjoint_set", "balaban", "trapezoid", "quadtree" };
+	return names[s];
+}
+
+bool PlanarIntersections::readCostFactors( std::istream& in )
+{
+	//factors are changed only if every line is correct
+	std::vector<double> factors( cost_factors );
+	std::string name;
+	double factor;
+	while( in>>name>>factor )
+	{
+		int s = 0;
+		while( s <= QUADTREE && name != solverName( (Solvers)s ) )
+			++s;
+		if( s > QUADTREE || factor <= 0 )
+			return false;
+		factors[s] = factor;
+	}
+	if( !in.eof() )
+		return false;
+	cost_factors.swap( factors );
+	return true;
+}
+
+void PlanarIntersections::writeCostFactors( std::ostream& out ) const
+{
+	for( int s = 0; s <= QUADTREE; ++s )
+		out<<solverName( (Solvers)s )<<" "<<cost_factors[s]<<std::endl;
+}
+
+DensityProbe PlanarIntersections::chooseSolvers()
+{
+	DensityProbe p = probeDensity();
+	Solvers candidates[] = { OTTMAN, NAIVE, SORTED_NAIVE, BALABAN, TRAPEZOID, QUADTREE };
+	intersection_solver = OTTMAN;
+	if( !build_arrangement ) {
+		for( Solvers s : candidates )
+		{
+			if( cost_factors[s] * costModel( s, p ) < cost_factors[intersection_solver] * costModel( intersection_solver, p ) )
+				intersection_solver = s;
+		}
+	}
+	graph_solver = cost_factors[BFS_GRAPH] * costModel( BFS_GRAPH, p ) < cost_factors[DISJOINT_SET] * costModel( DISJOINT_SET, p ) ? BFS_GRAPH : DISJOINT_SET;
+
+	//every intersection takes two pointers in lists, while matrix takes one bit for every pair of segments
+	dense_graph = p.intersections * 2 * sizeof( SegmentData* ) > (double)segments.size() * segments.size() / 8;
+	return p;
+}
+
+void PlanarIntersections::report(int s1, int s2, double x, double y)
+{
+	//Ottman-Bentley algorithm has to process every crossing, but not all are reported
+	if( !layersReported( s1, s2 ) || !chainReported( s1, s2 ) ) {
+		return;
+	}
+
+	++intersections_count;
+	visitor_call( visitor_data, segments[s1].getData(), segments[s2].getData(), x, y );
+}
+
+void PlanarIntersections::IntersectionStorage::operator()( SegmentData *a, SegmentData *b, double x, double y )
 {
-	sf::RectangleShape rectangle;
-	rectangle.setSize(sf::Vector2f(5, 5));
-	rectangle.setFillColor(sf::Color::Red);
-	rectangle.setPosition(x - 2 , y - 2);
-	squares.push_back(rectangle);
+	//data of segments is swapped during solving, so numbers of segments are recorded instead of their places
+	if( p.record_intersections ) {
+		Intersection i = { x, y, a->number, b->number };
+		p.intersections.push_back( i );
+	}
+	if( p.matrix_adjacency ) {
+		p.adjacency[ (size_t)a->number * p.adjacency_words + b->number / 64 ] |= 1ULL << ( b->number % 64 );
+		p.adjacency[ (size_t)b->number * p.adjacency_words + a->number / 64 ] |= 1ULL << ( a->number % 64 );
+		return;
+	}
+	a->neighbours.push_back( b );
+	b->neighbours.push_back( a );
 }
 
 bool PlanarIntersections::naive()
@@ -158,10 +523,9 @@ bool PlanarIntersections::naive()
 	{
 		for( unsigned int j = i+1; j < segments.size(); ++j )
 		{
+			if( !layersReported( i, j ) || !chainReported( i, j ) ) continue;
 			if( segments[i].intersects( segments[j], x, y ) ) {
-				addSquare(x, y);
-				segments[i].connect( segments[j] );
-				segments[j].connect( segments[i] );
+				report( i, j, x, y );
 			}
 		}
 	}
@@ -171,28 +535,21 @@ bool PlanarIntersections::naive()
 
 bool PlanarIntersections::sorted_naive()
 {
-	std::vector<Point> points;
+	std::vector<EndpointKey>& points = endpoint_keys;
 	std::list<int> opened_segments;
-	for( auto& s : segments )
-	{
-		points.push_back( s.getBeginning() );
-		points.push_back( s.getEnd() );
-	}
-
-	std::sort( points.begin(), points.end(), Point::cmp_point() );
+	sortEndpoints( segments, points, merged_keys );
 	
 	//the same as naive but don't compare segments which
 	//doesn't lay one under another
 	for( auto& p : points )
 	{
 		double x,y;
-		int i = p.getOwner();
-		if( p.getType() == BEGINNING ) {
+		int i = p.owner->getIndex();
+		if( p.type == BEGINNING ) {
 			for( int j : opened_segments ) {
+				if( !layersReported( i, j ) || !chainReported( i, j ) ) continue;
 				if( segments[i].intersects( segments[j], x, y ) ) {
-					addSquare( x, y);
-					segments[i].connect( segments[j] );
-					segments[j].connect( segments[i] );
+					report( i, j, x, y );
 				}
 			}
 			opened_segments.push_back(i);
@@ -205,190 +562,351 @@ bool PlanarIntersections::sorted_naive()
 }
 
 
-bool PlanarIntersections::computeBeginningPoint(std::set<Point, Point::cmp_point >& event_queue, 
-			std::set<Segment*, Segment::cmp_ptr>& segments_tree, Point& p)
+bool PlanarIntersections::balaban()
+{
+	BalabanSearch search( segments );
+	search.solve( [this]( int s1, int s2, double x, double y ) { report( s1, s2, x, y ); } );
+	return true;
+}
+
+
+bool PlanarIntersections::trapezoids()
+{
+	std::random_device rd;
+	trapezoid_map.build( segments, [this]( int s1, int s2, double x, double y ) { report( s1, s2, x, y ); }, rd() );
+	return true;
+}
+
+
+bool PlanarIntersections::quadtree()
+{
+	QuadtreeSearch search( segments );
+	search.solve( [this]( int s1, int s2, double x, double y ) { report( s1, s2, x, y ); } );
+	quadtree_stats = search.getStats();
+	return true;
+}
+
+
+void PlanarIntersections::scheduleCrossing(std::set<Point, Point::cmp_point >& event_queue, Segment *s1, Segment *s2, const Point& p)
+{
+	//edges of one x-monotone run of polyline never cross
+	if( s1->getRun() != -1 && s1->getRun() == s2->getRun() )
+		return;
+	double x,y;
+	if( !s1->intersects( *s2, x, y ) )
+		return;
+
+	//crossings in current point are already handled and earlier ones are gone
+	//crossing in place of already scheduled one joins it
+	Point crossing(x, y, CROSS, s1->getData(), s2->getData() );
+	if( !Segment::samePoint( crossing, p ) && Point::cmp_point()( p, crossing ) )
+		event_queue.insert( crossing );
+}
+
+
+template<class Status>
+bool PlanarIntersections::computeBeginningPoint(std::set<Point, Point::cmp_point >& event_queue, Status& status, Point& p)
 {	
-	typedef std::set<Segment*, Segment::cmp_ptr>::iterator seg_itr;	
+	typedef typename Status::Position position;
 	Segment *curr_segm = &(segments[p.getOwner()]);
 	
-	seg_itr curr_itr = segments_tree.insert( curr_segm ).first;
-	seg_itr predecessor = segments_tree.end();
-	seg_itr sucessor = segments_tree.end();
-	if( curr_itr != segments_tree.begin() ){
-		predecessor = std::prev(curr_itr);
+	position curr_itr = status.insert( curr_segm );
+
+	//segment begins on other segments, they are neighbours of new one in the status
+	int vertex = build_arrangement ? arrangement.vertexAt( p.x, p.y ) : -1;
+	position top = curr_itr;
+	for( position itr = curr_itr; status.hasNext(itr) && status.passesSweepPoint( status.next(itr) ); itr = status.next(itr) )
+	{
+		sweepReport( curr_segm->getIndex(), status.at( status.next(itr) )->getIndex(), p );
+		top = status.next(itr);
+		if( build_arrangement )
+			arrangement.touch( status.at(top)->getData()->number, vertex );
+	}
+	for( position itr = curr_itr; status.hasPrev(itr) && status.passesSweepPoint( status.prev(itr) ); itr = status.prev(itr) )
+	{
+		sweepReport( curr_segm->getIndex(), status.at( status.prev(itr) )->getIndex(), p );
+		if( build_arrangement )
+			arrangement.touch( status.at( status.prev(itr) )->getData()->number, vertex );
 	}
-	sucessor = std::next(curr_itr);
 
-	double x,y;
-	//neighbours of newly added segment are not their neighbours so delete their intersection from tree
-	if( predecessor != segments_tree.end() && sucessor != segments_tree.end() && (*predecessor)->intersects( *sucessor, x, y ) ){
-		event_queue.erase( Point(x, y, CROSS, (*predecessor)->getData(), (*sucessor)->getData() ) );
+	//segment lying above beginning tells in which face of arrangement new component lies
+	if( build_arrangement ) {
+		arrangement.touch( curr_segm->getData()->number, vertex );
+		while( status.hasNext(top) && status.at( status.next(top) )->isVertical() )
+			top = status.next(top);
+		arrangement.setAbove( vertex, status.hasNext(top) ? status.at( status.next(top) )->getData()->number : -1 );
 	}
-	
+
 	//check if new intersections showed up after insertion
-	if( predecessor != segments_tree.end() && (*predecessor)->intersects( *curr_itr, x, y ) ) {
-		if( !event_queue.insert( Point(x, y, CROSS, (*predecessor)->getData(), (*curr_itr)->getData() ) ).second )
-			return false;	
+	if( status.hasPrev(curr_itr) ) {
+		scheduleCrossing( event_queue, status.at( status.prev(curr_itr) ), curr_segm, p );
 	}
-
-	if( sucessor != segments_tree.end() && (*sucessor)->intersects( *curr_itr, x, y) ) {
-		if( !event_queue.insert( Point(x, y, CROSS, (*curr_itr)->getData(), (*sucessor)->getData() ) ).second )
-			return false;
+	if( status.hasNext(curr_itr) ) {
+		scheduleCrossing( event_queue, curr_segm, status.at( status.next(curr_itr) ), p );
 	}
 	return true;
 }
 
 
-bool PlanarIntersections::computeEndPoint(std::set<Point, Point::cmp_point >& event_queue, 
-			std::set<Segment*, Segment::cmp_ptr>& segments_tree, Point& p)
+template<class Status>
+bool PlanarIntersections::computeEndPoint(std::set<Point, Point::cmp_point >& event_queue, Status& status, Point& p)
 {
-	typedef std::set<Segment*, Segment::cmp_ptr>::iterator seg_itr;	
+	typedef typename Status::Position position;
 	Segment *curr_segm = &(segments[p.getOwner()]);
 
-	seg_itr curr_itr = segments_tree.insert( curr_segm ).first;
-	seg_itr predecessor = segments_tree.end();
-	seg_itr sucessor = segments_tree.end();
-	if( curr_itr != segments_tree.begin() ){
-		predecessor = std::prev(curr_itr);
+	//segment might touch others in its end without crossing being found
+	//if segment can't be found too much precision is needed for correct solving
+	position curr_itr;
+	if( !status.find( curr_segm, curr_itr ) ) {
+		return false;
 	}
-	sucessor = std::next(curr_itr);
 
-	double x,y;
-	//segment is erased so new crossing can be added
-	if( predecessor != segments_tree.end() && sucessor != segments_tree.end() ) {
-		if( (*predecessor)->intersects( *sucessor, x, y ) ) {
-			if( !smaller( x, p.x ) )
-				if( !event_queue.insert( Point(x, y, CROSS, (*predecessor)->getData(), (*sucessor)->getData() ) ).second ) 
-					return false;
-		}
+	//segments passing through end of segment get vertex of arrangement there
+	if( build_arrangement ) {
+		int vertex = arrangement.vertexAt( p.x, p.y );
+		arrangement.touch( curr_segm->getData()->number, vertex );
+		for( position itr = curr_itr; status.hasNext(itr) && status.passesSweepPoint( status.next(itr) ); itr = status.next(itr) )
+			arrangement.touch( status.at( status.next(itr) )->getData()->number, vertex );
+		for( position itr = curr_itr; status.hasPrev(itr) && status.passesSweepPoint( status.prev(itr) ); itr = status.prev(itr) )
+			arrangement.touch( status.at( status.prev(itr) )->getData()->number, vertex );
 	}
 
-	//segment ended so erase it from the tree
-	segments_tree.erase( curr_itr );
+	//segment is erased so its neighbours become neighbours of each other
+	if( status.hasPrev(curr_itr) && status.hasNext(curr_itr) ) {
+		scheduleCrossing( event_queue, status.at( status.prev(curr_itr) ), status.at( status.next(curr_itr) ), p );
+	}
+
+	//segment ended so erase it from the status
+	status.erase( curr_itr );
 	return true;
 }
 
 
-bool PlanarIntersections::computeCrossingPoint(std::set<Point, Point::cmp_point >& event_queue, 
-			std::set<Segment*, Segment::cmp_ptr>& segments_tree, Point& p)
+template<class Status>
+bool PlanarIntersections::computeCrossingPoint(std::set<Point, Point::cmp_point >& event_queue, Status& status, Point& p)
 {
-	typedef std::set<Segment*, Segment::cmp_ptr>::iterator seg_itr;	
-	seg_itr predecessor = segments_tree.end();
-	seg_itr sucessor = segments_tree.end();
+	typedef typename Status::Position position;
 
-	//segments intersect, connect them !
-	int s1 = p.getOwner();
-	int s2 = p.getIntersection();
-	segments[s1].connect(segments[s2]);
-	segments[s2].connect(segments[s1]);
-
-	//try to find neighbours of crossing segments
-	//if this fails too much precision is needed for correct solving
-	auto s1_itr = segments_tree.find( &segments[s1] );
-	auto s2_itr = segments_tree.find( &segments[s2] );
-	if( s1_itr == segments_tree.end() ) { 
-		return false;
-	}
-	if( s2_itr == segments_tree.end() ) {
+	//segments are still in order from before crossing
+	//if one of them can't be found too much precision is needed for correct solving
+	position first;
+	if( !status.find( &segments[p.getOwner()], first ) ) {
 		return false;
 	}
 
-	if( s1_itr != segments_tree.begin() ) {
-		predecessor = std::prev(s1_itr);
-	}
-	sucessor = std::next(s2_itr);
-
-	//add new square for drawing
-	double x,y;
-	segments[s1].intersects( segments[s2], x, y);
-	addSquare(x, y);
-
-	//check for new intersections
-	//delete intersctions of segments that won't be theirs neighbours anymore
-	if( sucessor != segments_tree.end() && (*sucessor)->intersects( *s2_itr, x, y) ){
-		event_queue.erase( Point(x, y, CROSS, (*s2_itr)->getData(), (*sucessor)->getData() ) );
+	//every segment passing through crossing point lies next to each other in the status
+	position last = first;
+	while( status.hasPrev(first) && status.passesSweepPoint( status.prev(first) ) )
+	{
+		first = status.prev(first);
 	}
-
-	if( predecessor != segments_tree.end() && (*predecessor)->intersects( *s1_itr, x, y) ){
-		event_queue.erase( Point(x, y, CROSS, (*predecessor)->getData(), (*s1_itr)->getData() ) );
+	while( status.hasNext(last) && status.passesSweepPoint( status.next(last) ) )
+	{
+		last = status.next(last);
 	}
 
-	if( sucessor != segments_tree.end() && (*sucessor)->intersects( *s1_itr, x, y) ){
-		if( !smaller( x, p.x) ) {
-			if( !event_queue.insert( Point(x, y, CROSS, (*s1_itr)->getData(), (*sucessor)->getData() ) ).second ) {
-				return false;
-			}
+	//segments intersect, connect them !
+	std::vector<Segment*> crossing;
+	for( position itr = first; ; itr = status.next(itr) )
+	{
+		for( Segment *s : crossing )
+		{
+			//colinear segments were connected when second of them began
+			if( !s->colinear( *status.at(itr) ) )
+				sweepReport( s->getIndex(), status.at(itr)->getIndex(), p );
 		}
+		crossing.push_back( status.at(itr) );
+		if( itr == last )
+			break;
 	}
 
-	if( predecessor != segments_tree.end() && (*predecessor)->intersects( *s2_itr, x, y) ) {
-		if( !smaller(x , p.x) ) {
-			if( !event_queue.insert( Point(x, y, CROSS, (*predecessor)->getData(), (*s2_itr)->getData() ) ).second ) {
-				return false;
-			}
-		}
+	//every segment passing through crossing gets the same vertex of arrangement
+	if( build_arrangement ) {
+		int vertex = arrangement.vertexAt( p.x, p.y );
+		for( Segment *s : crossing )
+			arrangement.touch( s->getData()->number, vertex );
 	}
 
-	//update special intersection of vertical segments
-	if( segments[s1].isVertical() )
-		segments[s1].setSpecialIntersection( segments[s2].sweepLineIntersection() );
-
-	if( segments[s2].isVertical() )
-		segments[s2].setSpecialIntersection( segments[s1].sweepLineIntersection() );
+	//segments after crossing are in reverse order
+	status.reverse( first, last );
 
-	//segments after crossing are in reverse order in segments tree so swap them
-	segments[s1].swap( segments[s2] );
+	//check for new intersections with segments around crossing ones
+	if( status.hasPrev(first) ) {
+		scheduleCrossing( event_queue, status.at( status.prev(first) ), status.at(first), p );
+	}
+	if( status.hasNext(last) ) {
+		scheduleCrossing( event_queue, status.at(last), status.at( status.next(last) ), p );
+	}
 	return true;
 }
 
-bool PlanarIntersections::OttmanBentley()
+void PlanarIntersections::sweepReport( int s1, int s2, const Point& p )
 {
-	//generate beginning priority queue
-	std::set<Point, Point::cmp_point > event_queue;
-	std::set<Segment*, Segment::cmp_ptr> segments_tree;
+	//segments pass through point of sweep within their tolerances, so pair can meet in places
+	//differing by their tolerances in y and until they move apart in x, nearly parallel ones are followed for limited length
+	const double max_reach = 1000 * sweep_precision;
+	const SegmentData *d1 = segments[s1].getData(), *d2 = segments[s2].getData();
+	double reach_y = d1->tolerance + d2->tolerance;
+	double reach_x = max_reach;
+	if( d1->vertical || d2->vertical )
+		reach_x = sweep_precision;
+	else if( d1->slope != d2->slope )
+		reach_x = std::min( max_reach, std::max( sweep_precision, 2 * reach_y / fabs( d1->slope - d2->slope ) ) );
 
-	//add points of segments to priority queue
-	for( auto& s : segments )
+	//sweep never moves back, pairs reported far behind can't meet here
+	while( place_first < place_reports.size() && place_reports[place_first].x < p.x - max_reach )
+		++place_first;
+	if( place_first > 1024 && 2 * place_first > place_reports.size() ) {
+		place_reports.erase( place_reports.begin(), place_reports.begin() + place_first );
+		place_first = 0;
+	}
+
+	//reports are sorted by place like events, only places close to current one are searched
+	PlaceReport r = { p.x, p.y, std::min( d1->number, d2->number ), std::max( d1->number, d2->number ) };
+	auto by_place = []( const PlaceReport& a, const PlaceReport& b ) { return a.x < b.x || ( a.x == b.x && a.y < b.y ); };
+	PlaceReport low = { p.x - reach_x, -std::numeric_limits<double>::infinity(), 0, 0 };
+	for( auto itr = std::lower_bound( place_reports.begin() + place_first, place_reports.end(), low, by_place ); itr != place_reports.end(); )
 	{
-		event_queue.insert(s.getBeginning());
-		event_queue.insert(s.getEnd());
+		//further back segments could be further in y
+		double x = itr->x;
+		double reach = reach_y + std::max( fabs( d1->slope ), fabs( d2->slope ) ) * ( p.x - x );
+		low = { x, p.y - reach, 0, 0 };
+		for( itr = std::lower_bound( itr, place_reports.end(), low, by_place ); itr != place_reports.end() && itr->x == x && itr->y <= p.y + reach; ++itr )
+		{
+			if( itr->s1 == r.s1 && itr->s2 == r.s2 )
+				return;
+		}
+		PlaceReport high = { x, std::numeric_limits<double>::infinity(), 0, 0 };
+		itr = std::upper_bound( itr, place_reports.end(), high, by_place );
+	}
+	place_reports.push_back( r );
+	report( s1, s2, p.x, p.y );
+}
+
+bool PlanarIntersections::OttmanBentley()
+{
+	//choose structure keeping segments crossing sweep line
+	if( status_structure == BLOCKED_STATUS ) {
+		BlockStatus status;
+		return OttmanBentley( status );
 	}
+	TreeStatus status;
+	return OttmanBentley( status );
+}
 
-	while( !event_queue.empty() )
+template<class Status>
+bool PlanarIntersections::OttmanBentley( Status& status )
+{
+	//beginnings and ends of segments are sorted once, queue keeps only crossings
+	std::vector<EndpointKey>& endpoints = endpoint_keys;
+	sortEndpoints( segments, endpoints, merged_keys );
+	std::set<Point, Point::cmp_point > event_queue;
+	status.reset( segments.size() );
+	place_reports.clear();
+	place_first = 0;
+	if( build_arrangement )
+		arrangement.reset( segments );
+
+	unsigned int next_endpoint = 0;
+	while( next_endpoint < endpoints.size() || !event_queue.empty() )
 	{
-		auto p = *(event_queue.begin());
-		Segment::setSweepLine( p );
-		event_queue.erase( p );
+		//take earlier of next ending point and first crossing
+		bool from_endpoints = event_queue.empty() || ( next_endpoint < endpoints.size() &&
+				Point::cmp_point()( endpoints[next_endpoint].toPoint(), *event_queue.begin() ) );
+		Point p = from_endpoints ? endpoints[next_endpoint++].toPoint() : *(event_queue.begin());
+		if( !from_endpoints )
+			event_queue.erase( event_queue.begin() );
+		status.setSweepPoint( p );
 		//parse point accordingly to its type
 		if(p.getType() == BEGINNING ) {
-			if( !computeBeginningPoint( event_queue, segments_tree, p) ) {
+			if( !computeBeginningPoint( event_queue, status, p) ) {
 				return false;
 			}
 		}
 		else if( p.getType() == END ){
-			if( !computeEndPoint( event_queue, segments_tree, p) ) {
+			if( !computeEndPoint( event_queue, status, p) ) {
 				return false;
 			}
 		}
 		else {
-			if( !computeCrossingPoint( event_queue, segments_tree, p) ) {
+			if( !computeCrossingPoint( event_queue, status, p) ) {
 				return false;
 			}
+			//crossings computed for different pairs of segments in the same place might differ a little
+			//all segments passing through this place are already handled
+			while( !event_queue.empty() && event_queue.begin()->getType() == CROSS && Segment::samePoint( *event_queue.begin(), p ) )
+			{
+				event_queue.erase( event_queue.begin() );
+			}
 		}
 	}
 
-	//if tree is not empty some segments failed to erase
+	//if status is not empty some segments failed to erase
 	//too much precision was needed and algorithm failed
-	return segments_tree.empty();
+	if( !status.empty() )
+		return false;
+	if( build_arrangement )
+		arrangement.build();
+	return true;
+}
+
+bool PlanarIntersections::anyIntersection()
+{
+	typedef std::set<Segment*, Segment::cmp_ptr>::iterator seg_itr;	
+	std::vector<EndpointKey>& points = endpoint_keys;
+	std::set<Segment*, Segment::cmp_ptr> segments_tree;
+	first_intersection = std::make_pair( -1, -1 );
+	sortEndpoints( segments, points, merged_keys );
+
+	//Shamos-Hoey: as long as no segments crossed, order of segments in tree doesn't change
+	//so only beginnings and ends are needed and first crossing is always found between neighbours
+	for( auto& k : points )
+	{
+		Point p = k.toPoint();
+		Segment::setSweepLine( p );
+		Segment *curr_segm = &(segments[p.getOwner()]);
+		seg_itr curr_itr = segments_tree.insert( curr_segm ).first;
+		seg_itr predecessor = segments_tree.end();
+		seg_itr sucessor = std::next(curr_itr);
+		if( curr_itr != segments_tree.begin() ) {
+			predecessor = std::prev(curr_itr);
+		}
+
+		double x,y;
+		if( p.getType() == BEGINNING ) {
+			//new segment crosses one of its neighbours
+			if( predecessor != segments_tree.end() && chainReported( (*predecessor)->getIndex(), (*curr_itr)->getIndex() ) && (*predecessor)->intersects( *curr_itr, x, y ) ) {
+				first_intersection = std::make_pair( (*predecessor)->getIndex(), (*curr_itr)->getIndex() );
+				return true;
+			}
+			if( sucessor != segments_tree.end() && chainReported( (*curr_itr)->getIndex(), (*sucessor)->getIndex() ) && (*sucessor)->intersects( *curr_itr, x, y ) ) {
+				first_intersection = std::make_pair( (*curr_itr)->getIndex(), (*sucessor)->getIndex() );
+				return true;
+			}
+		}
+		else {
+			//neighbours of ending segment become neighbours of each other
+			if( predecessor != segments_tree.end() && sucessor != segments_tree.end() && chainReported( (*predecessor)->getIndex(), (*sucessor)->getIndex() ) &&
+					(*predecessor)->intersects( *sucessor, x, y ) ) {
+				first_intersection = std::make_pair( (*predecessor)->getIndex(), (*sucessor)->getIndex() );
+				return true;
+			}
+			segments_tree.erase( curr_itr );
+		}
+	}
+	return false;
 }
 
 void PlanarIntersections::BFS()
 {
-	std::vector<bool> visited(segments.size(), false);
+	visited.assign(segments.size(), false);
 	int group_index = -1;
-	std::queue<SegmentData*> group;
+	//queue is kept in vector, so its memory is reused by next solving
+	queue.clear();
+	unsigned int head = 0;
 	SegmentData* s;
 	int index;
+	dataByNumber( numbered );
 	for(unsigned int i = 0; i < segments.size(); ++i)
 	{
 		//forget about visited vertexes
@@ -397,34 +915,128 @@ void PlanarIntersections::BFS()
 		if(visited[index]) continue;
 		
 		//all neighbours and their neighbours have the same group
-		group.push(s);
+		queue.push_back(s);
 		++group_index;
 		visited[index] = true;
 		s->setGroup(group_index);
 		//get all neighbours and their neighbours
-		while(!group.empty())
+		while(head < queue.size())
 		{
-			s = group.front();
+			s = queue[head];
 			index = s->getIndex();
-			auto neighbours = s->getNeighbours();
-			for( auto n : neighbours)
+			adjacent.assign( s->getNeighbours().begin(), s->getNeighbours().end() );
+			//edges of polyline are connected with edges next to them without being reported
+			int before, after;
+			chainNeighbours( s, before, after );
+			if( before != -1 )
+				adjacent.push_back( numbered[before] );
+			if( after != -1 )
+				adjacent.push_back( numbered[after] );
+			for( auto n : adjacent)
 			{
 				//all neighbours of this vertex are already parsed
 				if(visited[n->getIndex()]) continue;
 
 				visited[n->getIndex()] = true;
-				group.push(n);
+				queue.push_back(n);
 				n->setGroup(group_index);
 			}
-			group.pop();
+			++head;
 		}
 	}
 }
 
 
+bool PlanarIntersections::chooseMatrix()
+{
+	//matrix is indexed by numbers of segments, so they have to be numbered from zero
+	size_t n = segments.size();
+	if( count_only || snap_distance > 0 || n == 0 || adjacency_structure == LIST_ADJACENCY )
+		return false;
+	if( ( n + 63 ) / 64 * sizeof(unsigned long long) * n > MAX_MATRIX_BYTES )
+		return false;
+	for( auto& s : segments )
+	{
+		if( s.getData()->number >= (int)n )
+			return false;
+	}
+	if( adjacency_structure == MATRIX_ADJACENCY )
+		return true;
+
+	//searching matrix replaces BFS, disjoint-sets chosen for graph are kept
+	return graph_solver == BFS_GRAPH && dense_graph;
+}
+
+void PlanarIntersections::matrixBFS()
+{
+	int n = segments.size();
+	int words = adjacency_words;
+	numbered.assign( n, nullptr );
+	for( auto& s : segments )
+		numbered[ s.getData()->number ] = s.getData();
+
+	//edges of polyline are connected with edges next to them without being reported
+	for( int a = 0; a < n; ++a )
+	{
+		int before, after;
+		chainNeighbours( numbered[a], before, after );
+		if( after != -1 ) {
+			adjacency[ (size_t)a * words + after / 64 ] |= 1ULL << ( after % 64 );
+			adjacency[ (size_t)after * words + a / 64 ] |= 1ULL << ( a % 64 );
+		}
+	}
+
+	//segments not reached yet, frontier of search and next frontier
+	std::vector<unsigned long long> unvisited( words, ~0ULL ), frontier( words ), next( words );
+	if( n % 64 != 0 )
+		unvisited.back() = ( 1ULL << ( n % 64 ) ) - 1;
+
+	int group_index = -1;
+	for( int w = 0; w < words; ++w )
+	{
+		while( unvisited[w] != 0 )
+		{
+			int start = 64 * w + __builtin_ctzll( unvisited[w] );
+			unvisited[w] &= ~( 1ULL << ( start % 64 ) );
+			std::fill( frontier.begin(), frontier.end(), 0 );
+			frontier[w] = 1ULL << ( start % 64 );
+			++group_index;
+
+			bool growing = true;
+			while( growing )
+			{
+				std::fill( next.begin(), next.end(), 0 );
+				for( int fw = 0; fw < words; ++fw )
+				{
+					for( unsigned long long bits = frontier[fw]; bits != 0; bits &= bits - 1 )
+					{
+						int v = 64 * fw + __builtin_ctzll( bits );
+						numbered[v]->setGroup( group_index );
+						const unsigned long long *row = &adjacency[ (size_t)v * words ];
+						for( int i = 0; i < words; ++i )
+							next[i] |= row[i];
+					}
+				}
+
+				//only segments not reached before form next frontier
+				growing = false;
+				for( int i = 0; i < words; ++i )
+				{
+					next[i] &= unvisited[i];
+					unvisited[i] &= ~next[i];
+					growing = growing || next[i] != 0;
+				}
+				frontier.swap( next );
+			}
+		}
+	}
+}
+
 void PlanarIntersections::disjointSetFind()
 {
-	DisjointSet dset( segments.size() );
+	DisjointSet& dset = disjoint_set;
+	dset.reset( segments.size() );
+	dataByNumber( numbered );
 	for( auto& s : segments )
 	{
 		auto& neighbours = s.getNeighbours();
@@ -433,6 +1045,28 @@ void PlanarIntersections::disjointSetFind()
 			//make union of connected segments
 			dset.makeUnion( s.getIndex(), n->getIndex() );
 		}
+		//edges of polyline are connected with edges next to them without being reported
+		int before, after;
+		chainNeighbours( s.getData(), before, after );
+		if( after != -1 )
+			dset.makeUnion( s.getIndex(), numbered[after]->getIndex() );
+	}
+
+	//segments missing each other by less than snap distance are joined as if they touched
+	if( snap_distance > 0 ) {
+		snap_index.build( segments );
+		std::vector<int>& close = close_segments;
+		for( auto& s : segments )
+		{
+			const SegmentData *d = s.getData();
+			close.clear();
+			snap_index.queryDistance( d->x1, d->y1, d->x2, d->y2, snap_distance, close );
+			for( int other : close )
+			{
+				if( other > s.getIndex() && layersReported( s.getIndex(), other ) )
+					dset.makeUnion( s.getIndex(), other );
+			}
+		}
 	}
 
 	//set groups for segments
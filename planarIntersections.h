@@ -16,8 +16,13 @@
  *
  * =====================================================================================
  */
+#ifndef PLANAR_INTERSECTIONS_H
+#define PLANAR_INTERSECTIONS_H
+
 #include <stdlib.h>
+#include <algorithm>
 #include <iostream>
+#include <string>
 #include <random>
 #include <vector>
 #include <queue>
@@ -31,9 +36,32 @@
 
 #include "segment.h"
 #include "disjoint.h"
+#include "spatialIndex.h"
+#include "componentIndex.h"
+#include "renderer.h"
+#include "sweepStatus.h"
+#include "balaban.h"
+#include "trapezoidMap.h"
+#include "quadtree.h"
+#include "arrangement.h"
+
+//types of solvers: Bentley-Ottman, Naive, Naive with sorting, Broad-First-Search, Disjoint-Sets, Balaban, Trapezoidal map, Adaptive quadtree
+enum Solvers { OTTMAN, NAIVE, SORTED_NAIVE, BFS_GRAPH, DISJOINT_SET, BALABAN, TRAPEZOID, QUADTREE };
+
+/*
+ * features of segments estimated from their sample, used for predicting time of solvers
+ * intersections is expected number of crossings, active is expected number of segments crossing vertical line
+ */
+struct DensityProbe {
+	int segments;
+	double intersections;
+	double active;
+};
 
-//types of solvers: Bentley-Ottman, Naive, Naive with sorting, Broad-First-Search, Disjoint-Sets
-enum Solvers { OTTMAN, NAIVE, SORTED_NAIVE, BFS_GRAPH, DISJOINT_SET };
+//structures keeping segments crossing sweep line: red-black tree, sorted array divided into blocks
+enum StatusStructures { TREE_STATUS, BLOCKED_STATUS };
+//structures keeping crossing segments: lists of neighbours, bit matrix, chosen by density of segments
+enum AdjacencyStructures { LIST_ADJACENCY, MATRIX_ADJACENCY, AUTO_ADJACENCY };
 
 /*
  * class solving problem of intersecting segments on a plane and connected components of graph
@@ -49,7 +77,33 @@ public:
 	 */
 	void addSegment( const Segment& s );
 	void addSegment( double, double, double, double );
+	/*
+	 * add segment lying on given layer
+	 */
+	void addSegment( double, double, double, double, int layer );
+	/*
+	 * add polyline going through points given as x1 y1 x2 y2 ..., closed polyline is polygon ring
+	 * its consecutive edges touching only in shared vertex are not reported as crossing, but they are still connected
+	 * polyline is divided into x-monotone runs, edges of one run are never compared with each other
+	 */
+	void addPolyline( const std::vector<double>& points, bool closed, int layer = 0 );
+	/*
+	 * get number of added polylines
+	 */
+	int getPolylinesCount() const
+	{ return chains.size(); }
 	
+	/*
+	 * remove every segment with everything built from them, settings of solving are kept
+	 * numbers of new segments start from zero again
+	 * memory of segments and solvers is kept, so solving many sets one after another doesn't allocate it again
+	 */
+	void reset();
+	/*
+	 * reserve memory for given number of segments
+	 */
+	void reserve( int n );
+
 	/* 
 	 * generate given number of segments of maixmal length specified
 	 * clears all previous segments
@@ -64,6 +118,32 @@ public:
 	 * solve problem and if suceeded print time needed for computing
 	 */
 	double solveWithTime();
+	/*
+	 * find intersections calling visitor( a, b, x, y ) for every one as soon as solver finds it
+	 * a and b are numbers of crossing segments, x and y coordinates of their crossing
+	 * crossings are neither stored nor connected, so memory doesn't depend on their number
+	 * solve() visits the same crossings storing them in segments, or only counting them
+	 */
+	template<class Visitor>
+	bool visitIntersections( Visitor& visitor );
+
+	/*
+	 * test whether any two segments intersect, stops at first found crossing
+	 * uses Shamos-Hoey algorithm, doesn't connect segments
+	 * neighbouring edges of polyline touching in shared vertex don't count, so it tests whether polylines are simple
+	 */
+	bool anyIntersection();
+	/*
+	 * get indices of segments crossing found by last call of anyIntersection
+	 * both are -1 if no crossing was found
+	 */
+	std::pair<int, int> getFirstIntersection() const
+	{ return first_intersection; }
+
+	/*
+	 * get number of connected components found by last solving
+	 */
+	int countComponents() const;
 
 	/*
 	 * print info about every segments added to class
@@ -74,8 +154,44 @@ public:
 	 * create window showing every segment
 	 * connected segments have the same colour
 	 * may also add a red square for every intersection on plane
+	 * view can be moved and zoomed, only visible part of plane is drawn
 	 */
 	void visualize();
+	/*
+	 * draw segments to image file of given size without opening a window
+	 * segments and squares are drawn the same way as on visualization
+	 * return false if image couldn't be saved
+	 */
+	bool render( const std::string& path, unsigned int size = 1000 );
+
+	/*
+	 * build spatial index from current segments
+	 * index has to be rebuilt after adding or generating segments
+	 */
+	void buildIndex();
+	/*
+	 * get spatial index answering segment and window queries
+	 */
+	const SpatialIndex& getIndex() const
+	{ return spatial_index; }
+	/*
+	 * build index of connected components found by last solving, segments have to be connected by it
+	 */
+	void buildComponentIndex();
+	const ComponentIndex& getComponentIndex() const
+	{ return component_index; }
+
+	/*
+	 * get trapezoidal map built by last solving with trapezoid solver
+	 * it finds segments directly above and below any point
+	 */
+	const TrapezoidMap& getTrapezoidMap() const
+	{ return trapezoid_map; }
+	/*
+	 * get numbers describing subdivision made by last solving with quadtree solver
+	 */
+	const QuadtreeStats& getQuadtreeStats() const
+	{ return quadtree_stats; }
 
 	/* 
 	 * get intersection solver
@@ -98,6 +214,37 @@ public:
 	void setGraphSolver( Solvers s)
 	{ graph_solver = s; }
 
+	/*
+	 * get structure keeping segments crossing sweep line in Bentley-Ottman algorithm
+	 */
+	StatusStructures getStatusStructure() const
+	{ return status_structure; }
+	/*
+	 * set structure keeping segments crossing sweep line in Bentley-Ottman algorithm
+	 */
+	void setStatusStructure( StatusStructures s )
+	{ status_structure = s; }
+
+	/*
+	 * get or set structure keeping crossing segments, lists of neighbours are used by default
+	 * with bit matrix neighbours are not filled and components are found by searching rows of matrix a word at a time
+	 * automatic structure chooses matrix only for BFS and only if density estimated by chooseSolvers() makes it smaller
+	 * matrix is never used if it would take more than MAX_MATRIX_BYTES
+	 */
+	AdjacencyStructures getAdjacencyStructure() const
+	{ return adjacency_structure; }
+	void setAdjacencyStructure( AdjacencyStructures a )
+	{ adjacency_structure = a; }
+	/*
+	 * return whether last solving kept crossings in bit matrix
+	 */
+	bool matrixAdjacency() const
+	{ return matrix_adjacency; }
+	/*
+	 * the biggest number of bytes taken by bit matrix, about 23000 segments
+	 */
+	static const size_t MAX_MATRIX_BYTES = 64 << 20;
+
 	/*
 	 * return whether squares are drawn
 	 */
@@ -105,9 +252,40 @@ public:
 	{ return draw_squares; }
 	/*
 	 * set drawing squares on visualization
+	 * squares are drawn on intersections, so they are recorded from now on
 	 */
 	void setDrawSquares( bool d )
-	{ draw_squares = d; }
+	{ draw_squares = d; record_intersections = record_intersections || d; }
+	/*
+	 * return whether solvers record every found intersection
+	 */
+	bool recordIntersections() const
+	{ return record_intersections; }
+	/*
+	 * set recording coordinates and segments of every found intersection during solving
+	 */
+	void setRecordIntersections( bool r )
+	{ record_intersections = r; }
+	/*
+	 * get intersections recorded by last solving
+	 */
+	const std::vector<Intersection>& getIntersections() const
+	{ return intersections; }
+	/*
+	 * return whether Bentley-Ottman algorithm builds arrangement of segments
+	 */
+	bool buildArrangement() const
+	{ return build_arrangement; }
+	/*
+	 * set building arrangement of segments while sweeping, other solvers don't build it
+	 */
+	void setBuildArrangement( bool b )
+	{ build_arrangement = b; }
+	/*
+	 * get arrangement built by last solving
+	 */
+	const Arrangement& getArrangement() const
+	{ return arrangement; }
 	/*
 	 * get minimal coordinate for generated segments
 	 */
@@ -134,9 +312,96 @@ public:
 	 */
 	double getComplexity( int n );
 
+	/*
+	 * estimate density of segments from random sample of given size
+	 * every pair of sampled segments is tested, so sample should be small
+	 */
+	DensityProbe probeDensity( int sample = 1000 ) const;
+	/*
+	 * get number of operations solver makes for segments described by probe
+	 * multiplied by cost factor of solver it gives predicted time of solving
+	 */
+	static double costModel( Solvers s, const DensityProbe& p );
+	/*
+	 * get or set seconds needed for one operation of solver, measured by calibrating solvers on benchmark
+	 */
+	double getCostFactor( Solvers s ) const
+	{ return cost_factors[s]; }
+	void setCostFactor( Solvers s, double f )
+	{ cost_factors[s] = f; }
+	/*
+	 * read or write cost factors as lines: solver factor, where solver is name of its command line option
+	 * if any line is wrong reading returns false and factors are not changed
+	 */
+	bool readCostFactors( std::istream& in );
+	void writeCostFactors( std::ostream& out ) const;
+	/*
+	 * get name of command line option choosing solver
+	 */
+	static const char *solverName( Solvers s );
+	/*
+	 * choose intersection and graph solvers with the lowest predicted time for current segments
+	 * arrangement is built only by Ottman-Bentley algorithm, so it is kept if arrangement is needed
+	 * estimated density is also kept for automatic structure of crossing segments
+	 */
+	DensityProbe chooseSolvers();
+
 	void setDenseData( bool d )
 	{ denseData = d; }
 
+	/*
+	 * return whether solvers only count intersections
+	 */
+	bool countOnly() const
+	{ return count_only; }
+	/*
+	 * set counting intersections without storing them
+	 * segments are not connected and connected components are not searched
+	 */
+	void setCountOnly( bool c )
+	{ count_only = c; }
+	/*
+	 * get or set distance at which segments are connected even if they don't intersect
+	 * gaps are not counted as intersections, with positive distance components are found with disjoint-sets
+	 */
+	double getSnapDistance() const
+	{ return snap_distance; }
+	void setSnapDistance( double d )
+	{ snap_distance = d; }
+	/*
+	 * return whether segments are divided into layers
+	 */
+	bool layered() const
+	{ return use_layers; }
+	/*
+	 * set reporting only crossings of segments from given pairs of layers
+	 * if no pairs are given every crossing of segments from different layers is reported
+	 * layers have to be numbers from 0 to MAX_LAYERS - 1
+	 */
+	void setLayerPairs( const std::vector<std::pair<int, int> >& pairs );
+	/*
+	 * report crossings of every pair of segments again, ignore layers
+	 */
+	void clearLayers()
+	{ use_layers = false; }
+
+	/*
+	 * maximal number of layers segments can be divided into
+	 */
+	static const int MAX_LAYERS = 64;
+
+	/*
+	 * get segments being solved, their data moves between them while sweeping
+	 */
+	const std::vector<Segment>& getSegments() const
+	{ return segments; }
+
+	/*
+	 * get number of intersections found by last solving
+	 */
+	long long getIntersectionsCount() const
+	{ return intersections_count; }
+
 private:
 	/*
 	 * use naive solver to find intersections of segments on plane
@@ -150,36 +415,150 @@ private:
 	 * use Bentley-Ottman algorithm to find intersections of segments on plane
 	 */
 	bool OttmanBentley();
+	/*
+	 * sweep plane keeping segments crossing sweep line in given status structure
+	 */
+	template<class Status>
+	bool OttmanBentley( Status& status );
+	/*
+	 * use Balaban's algorithm to find intersections of segments on plane
+	 * its time depends on number of intersections, so it works well for both sparse and dense data
+	 */
+	bool balaban();
+	/*
+	 * build trapezoidal map of segments inserted in random order, crossings are found while tracing them
+	 * map is kept for point location queries after solving
+	 */
+	bool trapezoids();
+	/*
+	 * divide plane by adaptive quadtree and search its leaves in parallel
+	 * small leaves are searched by brute force and bigger ones by sweep
+	 */
+	bool quadtree();
 
+	/*
+	 * add crossing of two segments to event queue if it lies after given point
+	 */
+	void scheduleCrossing(std::set<Point, Point::cmp_point >& event_queue, Segment *s1, Segment *s2, const Point& p);
 	/*
 	 * compute beginning, end or crossing point for Bentley-Ottman algorithm
+	 * crossing point handles every segment passing through it at once
+	 */
+	template<class Status>
+	bool computeBeginningPoint(std::set<Point, Point::cmp_point >& event_queue, Status& status, Point& p);
+	template<class Status>
+	bool computeEndPoint(std::set<Point, Point::cmp_point >& event_queue, Status& status, Point& p);
+	template<class Status>
+	bool computeCrossingPoint(std::set<Point, Point::cmp_point >& event_queue, Status& status, Point& p);
+	/*
+	 * report segments meeting in point of sweep, unless they were reported in the same place already
+	 * crossings computed for different pairs in one place may differ a little, then segments passing
+	 * through that place are found again by events handled between them
 	 */
-	bool computeBeginningPoint(std::set<Point, Point::cmp_point >& event_queue, std::set<Segment*, Segment::cmp_ptr>& segments_tree, Point& p);
-	bool computeEndPoint(std::set<Point, Point::cmp_point >& event_queue, std::set<Segment*, Segment::cmp_ptr>& segments_tree, Point& p);
-	bool computeCrossingPoint(std::set<Point, Point::cmp_point >& event_queue, std::set<Segment*, Segment::cmp_ptr>& segments_tree, Point& p);
+	void sweepReport( int s1, int s2, const Point& p );
 
 	/*
 	 * use Broad-First-Search algorithm to find connected components of graph
 	 */
 	void BFS();
+	/*
+	 * decide whether crossings are kept in bit matrix, automatic structure uses density estimated by chooseSolvers()
+	 * so segments are not probed again on every solving
+	 */
+	bool chooseMatrix();
+	/*
+	 * find connected components with Broad-First-Search over bit matrix
+	 * rows of every segment in frontier are joined word by word into next frontier
+	 */
+	void matrixBFS();
 	/*
 	 * use disjoints-sets to find connected components of graph
+	 * segments closer than snap distance are joined as well, found by spatial index
 	 */
 	void disjointSetFind();
 
 	/*
-	 * add new square representing new intersection of segments
+	 * test whether crossing of segments with given indices should be reported
+	 */
+	bool layersReported( int s1, int s2 ) const
+	{
+		return !use_layers || ( layer_mask[ segments[s1].getLayer() ] >> segments[s2].getLayer() ) & 1;
+	}
+
+	/*
+	 * test whether crossing of segments with given indices should be reported
+	 * edges of polyline touching its neighbouring edge only in their shared vertex are not
+	 */
+	bool chainReported( int s1, int s2 ) const;
+	/*
+	 * get numbers of edges before and after given edge in its polyline, -1 if there is no such edge
+	 */
+	void chainNeighbours( const SegmentData *d, int& before, int& after ) const;
+	/*
+	 * get data of every segment placed by its number, nothing is needed if there are no polylines
+	 */
+	void dataByNumber( std::vector<SegmentData*>& numbered ) const;
+	/*
+	 * add segment reusing one of spare segments if there is any
+	 */
+	Segment& newSegment( double x1, double y1, double x2, double y2 );
+
+	/*
+	 * run chosen solver for finding intersections, crossings of previous solving are forgotten
+	 */
+	bool findIntersections();
+	/*
+	 * called by every solver for every found intersection of segments with given indices
+	 * counts intersection and passes it to visitor
+	 */
+	void report(int, int, double, double);
+	/*
+	 * run solver for finding intersections passing every one to given visitor of data of crossing segments
+	 * visitor is forgotten after solving, also if solver throws
+	 */
+	template<class DataVisitor>
+	bool visitData( DataVisitor& visitor );
+	/*
+	 * default visitor used by solve(), records intersection and connects segments in lists or matrix
+	 */
+	struct IntersectionStorage {
+		PlanarIntersections& p;
+		void operator()( SegmentData *a, SegmentData *b, double x, double y );
+	};
+	/*
+	 * visitor passing numbers of crossing segments to visitor given to visitIntersections
 	 */
-	void addSquare(int, int);
+	template<class Visitor>
+	struct NumbersVisitor {
+		Visitor& visitor;
+		void operator()( SegmentData *a, SegmentData *b, double x, double y )
+		{ visitor( a->number, b->number, x, y ); }
+	};
 
 	/*
-	 * vector of squares representing intersections on plane
+	 * intersections found by last solving, recorded only if requested
 	 */
-	std::vector<sf::RectangleShape> squares;
+	std::vector<Intersection> intersections;
 	/*
 	 * vector of segments from which we solve a problem
 	 */
 	std::vector<Segment> segments;	
+	/*
+	 * spatial index built from segments for answering queries after solving
+	 */
+	SpatialIndex spatial_index;
+	/*
+	 * connected components of solved segments for answering queries after solving
+	 */
+	ComponentIndex component_index;
+	/*
+	 * trapezoidal map built by trapezoid solver
+	 */
+	TrapezoidMap trapezoid_map;
+	/*
+	 * subdivision made by last solving with quadtree solver
+	 */
+	QuadtreeStats quadtree_stats;
 	/*
 	 * minimal and maximal coordinate of generated segments
 	 */
@@ -188,6 +567,22 @@ private:
 	 * solvers for solving a problem
 	 */
 	Solvers graph_solver, intersection_solver;
+	/*
+	 * structure used by Bentley-Ottman algorithm
+	 */
+	StatusStructures status_structure;
+	/*
+	 * structure chosen for keeping crossing segments and structure used by last solving
+	 * bits of row a of adjacency matrix are set for segments crossing segment of number a
+	 */
+	AdjacencyStructures adjacency_structure;
+	bool matrix_adjacency;
+	/*
+	 * indicate lists of neighbours of intersections estimated by last chooseSolvers() would be bigger than matrix
+	 */
+	bool dense_graph;
+	std::vector<unsigned long long> adjacency;
+	int adjacency_words;
 	/*
 	 * test whether squares should be drawn or not
 	 */
@@ -196,4 +591,122 @@ private:
 	 * indicate data for solving will be hard for solving
 	 */
 	bool denseData;
-};
\ No newline at end of file
+	/*
+	 * indicate only number of intersections is needed
+	 */
+	bool count_only;
+	/*
+	 * distance at which segments are connected, zero if they have to intersect
+	 */
+	double snap_distance;
+	/*
+	 * indicate found intersections are recorded
+	 */
+	bool record_intersections;
+	/*
+	 * indicate arrangement is built while sweeping
+	 */
+	bool build_arrangement;
+	/*
+	 * arrangement of segments built by last sweep
+	 */
+	Arrangement arrangement;
+	/*
+	 * number of intersections found by last solving
+	 */
+	long long intersections_count;
+	/*
+	 * indicate only crossings of chosen layers are reported
+	 */
+	bool use_layers;
+	/*
+	 * bit j of layer_mask[i] is set if crossings of layers i and j are reported
+	 */
+	std::vector<unsigned long long> layer_mask;
+	/*
+	 * added polyline with numbers of its first and last edge
+	 */
+	struct Chain {
+		int first, last;
+		bool closed;
+	};
+	std::vector<Chain> chains;
+	/*
+	 * number of x-monotone runs of every polyline
+	 */
+	int runs_count;
+	/*
+	 * seconds needed for one operation of every solver
+	 */
+	std::vector<double> cost_factors;
+	/*
+	 * indices of crossing segments found by anyIntersection
+	 */
+	std::pair<int, int> first_intersection;
+	/*
+	 * numbers of pair of segments reported by Bentley-Ottman algorithm in given place
+	 */
+	struct PlaceReport {
+		double x, y;
+		int s1, s2;
+	};
+	/*
+	 * reports in places close to sweep line, in order of sweep
+	 * reports before first one are left behind and wait for removal
+	 */
+	std::vector<PlaceReport> place_reports;
+	size_t place_first;
+	/*
+	 * segments removed by reset, reused by next added ones with their memory
+	 */
+	std::vector<Segment> spare_segments;
+	/*
+	 * buffers of graph solvers kept between solves
+	 */
+	std::vector<bool> visited;
+	std::vector<SegmentData*> queue, adjacent, numbered;
+	std::vector<int> close_segments;
+	DisjointSet disjoint_set;
+	/*
+	 * index finding segments close to each other for snapping, separate from index answering queries
+	 */
+	SpatialIndex snap_index;
+	/*
+	 * sorted endpoints of segments and buffer for merging them, kept between solves
+	 */
+	std::vector<EndpointKey> endpoint_keys, merged_keys;
+	/*
+	 * visitor of intersections called through function made for its type, set only while finding intersections
+	 */
+	void (*visitor_call)( void*, SegmentData*, SegmentData*, double, double );
+	void *visitor_data;
+};
+
+template<class Visitor>
+bool PlanarIntersections::visitIntersections( Visitor& visitor )
+{
+	NumbersVisitor<Visitor> numbers = { visitor };
+	return visitData( numbers );
+}
+
+template<class DataVisitor>
+bool PlanarIntersections::visitData( DataVisitor& visitor )
+{
+	//function made for type of visitor has its call inlined, so every crossing costs one indirect call
+	visitor_call = []( void *v, SegmentData *a, SegmentData *b, double x, double y ) { (*(DataVisitor*)v)( a, b, x, y ); };
+	visitor_data = &visitor;
+	bool solved;
+	try {
+		solved = findIntersections();
+	}
+	catch( ... ) {
+		visitor_call = nullptr;
+		visitor_data = nullptr;
+		throw;
+	}
+	visitor_call = nullptr;
+	visitor_data = nullptr;
+	return solved;
+}
+
+#endif
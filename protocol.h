@@ -0,0 +1,101 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  protocol.h
+ *
+ *    Description:  Binary protocol of requests and responses exchanged by solver server and its clients.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:27:56
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/*
+ * binary protocol of solver server, used by server and its client over Unix domain socket
+ * every request is header followed by payload, every response is header followed by payload
+ * numbers are written in native byte order, both sides work on the same machine
+ *
+ * payloads of requests and responses:
+ * CREATE_SET: nothing -> uint32 set
+ * DROP_SET: nothing -> nothing
+ * INSERT_SEGMENTS: double x1 y1 x2 y2 for every segment -> uint32 id of first segment, uint32 count
+ * REMOVE_SEGMENTS: uint32 ids -> uint32 number of removed segments
+ * SOLVE_SET: nothing -> int64 intersections, uint32 components, double seconds
+ * QUERY_SEGMENT: double x1 y1 x2 y2 -> uint32 ids of segments crossing segment
+ * QUERY_WINDOW: double x1 y1 x2 y2 -> uint32 ids of segments lying in rectangle
+ * SEGMENT_CROSSINGS: uint32 id -> uint32 ids of segments crossing it
+ * SEGMENT_COMPONENTS: uint32 ids -> int32 component of every segment, -1 for removed ones
+ * SHUTDOWN_SERVER: nothing -> nothing
+ */
+enum ServerCommand { CREATE_SET = 1, DROP_SET, INSERT_SEGMENTS, REMOVE_SEGMENTS, SOLVE_SET,
+	QUERY_SEGMENT, QUERY_WINDOW, SEGMENT_CROSSINGS, SEGMENT_COMPONENTS, SHUTDOWN_SERVER };
+
+/*
+ * status of response: success, wrong request, set not existing or solving failed
+ */
+enum ServerStatus { STATUS_OK = 0, STATUS_BAD_REQUEST, STATUS_NO_SET, STATUS_FAILED };
+
+/*
+ * size is number of bytes of payload following header
+ */
+struct RequestHeader {
+	uint32_t command;
+	uint32_t set;
+	uint32_t size;
+};
+
+struct ResponseHeader {
+	uint32_t status;
+	uint32_t size;
+};
+
+/*
+ * the biggest accepted payload
+ */
+const uint32_t MAX_PAYLOAD = 1u << 30;
+
+/*
+ * read or write whole buffer from socket, return false if connection was closed or failed
+ */
+inline bool receiveAll( int fd, void *buffer, size_t size )
+{
+	char *p = (char*)buffer;
+	while( size > 0 )
+	{
+		ssize_t got = recv( fd, p, size, 0 );
+		if( got <= 0 )
+			return false;
+		p += got;
+		size -= got;
+	}
+	return true;
+}
+
+inline bool sendAll( int fd, const void *buffer, size_t size )
+{
+	const char *p = (const char*)buffer;
+	while( size > 0 )
+	{
+		//closed client must not kill server with signal
+		ssize_t sent = send( fd, p, size, MSG_NOSIGNAL );
+		if( sent <= 0 )
+			return false;
+		p += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+#endif
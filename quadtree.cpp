@@ -0,0 +1,207 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  quadtree.cpp
+ *
+ *    Description:  Adaptive quadtree of segments finding intersections inside its leaves in parallel.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:12:58
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "quadtree.h"
+
+QuadtreeSearch::QuadtreeSearch( const std::vector<Segment>& s ) : segments( s ), min_x( 0 ), min_y( 0 ), max_x( 0 ), max_y( 0 )
+{
+	double largest = 0;
+	for( unsigned int i = 0; i < segments.size(); ++i )
+	{
+		SegmentData *d = segments[i].getData();
+		Box b = { d->x1, std::min( d->y1, d->y2 ), d->x2, std::max( d->y1, d->y2 ) };
+		boxes.push_back( b );
+		if( i == 0 ) {
+			min_x = b.x1; min_y = b.y1;
+			max_x = b.x2; max_y = b.y2;
+		}
+		min_x = std::min( min_x, b.x1 ); min_y = std::min( min_y, b.y1 );
+		max_x = std::max( max_x, b.x2 ); max_y = std::max( max_y, b.y2 );
+		largest = std::max( largest, std::max( std::max( fabs( b.x1 ), fabs( b.x2 ) ), std::max( fabs( b.y1 ), fabs( b.y2 ) ) ) );
+	}
+	//computed crossing might lie a little outside boxes of its segments
+	margin = sweep_precision * ( 1 + largest );
+
+	stats.leaves = stats.brute_leaves = stats.sweep_leaves = stats.depth = 0;
+	stats.copies = 0;
+	subdivide();
+}
+
+void QuadtreeSearch::subdivide()
+{
+	leaves.clear();
+	if( segments.empty() )
+		return;
+
+	std::vector<Cell> cells( 1 );
+	Cell& root = cells.back();
+	root.x1 = min_x; root.y1 = min_y;
+	root.x2 = max_x; root.y2 = max_y;
+	root.depth = 0;
+	for( unsigned int i = 0; i < boxes.size(); ++i )
+		root.items.push_back( i );
+
+	while( !cells.empty() )
+	{
+		Cell cell;
+		std::swap( cell, cells.back() );
+		cells.pop_back();
+
+		if( (int)cell.items.size() > LEAF_SIZE && cell.depth < MAX_DEPTH ) {
+			double middle_x = ( cell.x1 + cell.x2 ) / 2, middle_y = ( cell.y1 + cell.y2 ) / 2;
+			Cell quarters[4];
+			for( int q = 0; q < 4; ++q )
+			{
+				quarters[q].x1 = q & 1 ? middle_x : cell.x1;
+				quarters[q].x2 = q & 1 ? cell.x2 : middle_x;
+				quarters[q].y1 = q & 2 ? middle_y : cell.y1;
+				quarters[q].y2 = q & 2 ? cell.y2 : middle_y;
+				quarters[q].depth = cell.depth + 1;
+			}
+			size_t copies = 0;
+			for( int i : cell.items )
+			{
+				const Box& b = boxes[i];
+				for( auto& q : quarters )
+				{
+					if( b.x1 <= q.x2 + margin && b.x2 >= q.x1 - margin && b.y1 <= q.y2 + margin && b.y2 >= q.y1 - margin ) {
+						q.items.push_back( i );
+						++copies;
+					}
+				}
+			}
+
+			//segments spanning the whole cell would be copied into every quarter, splitting such cell only makes more work
+			if( copies <= 2 * cell.items.size() ) {
+				for( auto& q : quarters )
+				{
+					if( !q.items.empty() ) {
+						cells.push_back( Cell() );
+						std::swap( cells.back(), q );
+					}
+				}
+				continue;
+			}
+		}
+
+		stats.depth = std::max( stats.depth, cell.depth );
+		stats.copies += cell.items.size();
+		if( (int)cell.items.size() <= BRUTE_SIZE )
+			++stats.brute_leaves;
+		else
+			++stats.sweep_leaves;
+		leaves.push_back( Cell() );
+		std::swap( leaves.back(), cell );
+	}
+	stats.leaves = leaves.size();
+
+	//the biggest leaves are taken by threads first, so small ones fill the end
+	std::sort( leaves.begin(), leaves.end(), []( const Cell& a, const Cell& b ) { return a.items.size() > b.items.size(); } );
+}
+
+void QuadtreeSearch::solve( const Reporter& report, int threads )
+{
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+	threads = std::max( 1, std::min<int>( threads, leaves.size() ) );
+
+	//every thread takes next leaf waiting for search and keeps its own crossings
+	std::vector<std::vector<Crossing> > found( threads );
+	std::atomic<int> next_leaf( 0 );
+	auto worker = [&]( int t ) {
+		int l;
+		while( ( l = next_leaf++ ) < (int)leaves.size() )
+			searchLeaf( leaves[l], found[t] );
+	};
+
+	std::vector<std::thread> workers;
+	for( int t = 1; t < threads; ++t )
+		workers.push_back( std::thread( worker, t ) );
+	worker( 0 );
+	for( auto& w : workers )
+		w.join();
+
+	for( auto& f : found )
+	{
+		for( auto& c : f )
+			report( c.s1, c.s2, c.x, c.y );
+	}
+}
+
+void QuadtreeSearch::searchLeaf( const Cell& leaf, std::vector<Crossing>& found ) const
+{
+	const std::vector<int>& items = leaf.items;
+	if( (int)items.size() <= BRUTE_SIZE ) {
+		for( unsigned int i = 0; i < items.size(); ++i )
+		{
+			const Box& a = boxes[ items[i] ];
+			for( unsigned int j = i + 1; j < items.size(); ++j )
+			{
+				const Box& b = boxes[ items[j] ];
+				if( a.x1 <= b.x2 && b.x1 <= a.x2 && a.y1 <= b.y2 && b.y1 <= a.y2 )
+					check( leaf, items[i], items[j], found );
+			}
+		}
+		return;
+	}
+
+	//sweep leaf along x, box is opened until sweep passes its right side
+	std::vector<int> order( items );
+	std::sort( order.begin(), order.end(), [&]( int a, int b ) { return boxes[a].x1 < boxes[b].x1; } );
+	std::vector<int> opened;
+	for( int i : order )
+	{
+		const Box& a = boxes[i];
+		unsigned int kept = 0;
+		for( int j : opened )
+		{
+			const Box& b = boxes[j];
+			if( b.x2 < a.x1 )
+				continue;
+			opened[kept++] = j;
+			if( a.y1 <= b.y2 && b.y1 <= a.y2 )
+				check( leaf, i, j, found );
+		}
+		opened.resize( kept );
+		opened.push_back( i );
+	}
+}
+
+void QuadtreeSearch::check( const Cell& leaf, int a, int b, std::vector<Crossing>& found ) const
+{
+	//segments are always tested in the same order, so every leaf computes the same crossing
+	if( a > b )
+		std::swap( a, b );
+	double x, y;
+	if( !segments[a].intersects( segments[b], x, y ) )
+		return;
+
+	//crossing lying on border of leaves belongs to the one above and right of it
+	double cx = std::max( min_x, std::min( x, max_x ) );
+	double cy = std::max( min_y, std::min( y, max_y ) );
+	if( cx < leaf.x1 || cy < leaf.y1 )
+		return;
+	if( ( cx >= leaf.x2 && leaf.x2 != max_x ) || ( cy >= leaf.y2 && leaf.y2 != max_y ) )
+		return;
+	Crossing c = { a, b, x, y };
+	found.push_back( c );
+}
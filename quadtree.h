@@ -0,0 +1,131 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  quadtree.h
+ *
+ *    Description:  Adaptive quadtree of segments finding intersections inside its leaves in parallel.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:12:58
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef QUADTREE_H
+#define QUADTREE_H
+
+#include <functional>
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * numbers describing subdivision made by last search: leaves of every strategy,
+ * depth of the deepest leaf and number of segments in all leaves together
+ */
+struct QuadtreeStats {
+	int leaves;
+	int brute_leaves, sweep_leaves;
+	int depth;
+	long long copies;
+};
+
+/*
+ * class finding intersections of segments divided by adaptive quadtree
+ * cells with too many segments are split into quarters, so dense clusters get small cells and empty parts of plane big ones
+ * every leaf is searched on its own by strategy fitting its size: brute force for tiny leaves, sweep for bigger ones
+ * leaves are searched by many threads, crossing is reported only by leaf containing it, so segments spanning many leaves don't duplicate it
+ */
+class QuadtreeSearch
+{
+public:
+	/*
+	 * function called for every found intersection with indices of crossing segments and coordinates of crossing
+	 */
+	typedef std::function<void( int, int, double, double )> Reporter;
+
+	/*
+	 * cells with more segments are split, leaves with at most BRUTE_SIZE segments are searched by brute force
+	 */
+	static const int LEAF_SIZE = 128;
+	static const int BRUTE_SIZE = 24;
+	static const int MAX_DEPTH = 20;
+
+	/*
+	 * build subdivision of given segments, they can't change until search is finished
+	 */
+	QuadtreeSearch( const std::vector<Segment>& segments );
+
+	/*
+	 * find every intersection of segments using given number of threads, if it is not positive number of hardware threads is used
+	 * every pair of crossing segments is reported once, always from calling thread
+	 */
+	void solve( const Reporter& report, int threads = 0 );
+
+	/*
+	 * get numbers describing subdivision
+	 */
+	const QuadtreeStats& getStats() const
+	{ return stats; }
+
+private:
+	/*
+	 * bounding box of segment
+	 */
+	struct Box {
+		double x1, y1, x2, y2;
+	};
+
+	/*
+	 * cell of subdivision with indices of segments reaching it
+	 * cell contains points from its lower to its upper coordinates, upper ones excluded unless they bound whole plane
+	 */
+	struct Cell {
+		double x1, y1, x2, y2;
+		int depth;
+		std::vector<int> items;
+	};
+
+	/*
+	 * crossing found in leaf, reported after every leaf is searched
+	 */
+	struct Crossing {
+		int s1, s2;
+		double x, y;
+	};
+
+	/*
+	 * split cells until every one is small enough or splitting doesn't make them smaller
+	 */
+	void subdivide();
+	/*
+	 * search leaf by brute force or sweep, crossings it contains are written to found
+	 */
+	void searchLeaf( const Cell& leaf, std::vector<Crossing>& found ) const;
+	/*
+	 * test pair of segments and keep their crossing if it lies in leaf
+	 */
+	void check( const Cell& leaf, int a, int b, std::vector<Crossing>& found ) const;
+
+	/*
+	 * searched segments and their bounding boxes
+	 */
+	const std::vector<Segment>& segments;
+	std::vector<Box> boxes;
+	/*
+	 * leaves of subdivision
+	 */
+	std::vector<Cell> leaves;
+	/*
+	 * bounds of whole plane and distance by which boxes are enlarged when put into cells
+	 */
+	double min_x, min_y, max_x, max_y;
+	double margin;
+	QuadtreeStats stats;
+};
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  renderer.cpp
+ *
+ *    Description:  Rendering segments, intersections and components from batched, tiled vertex buffers
+ *    				to window or image file.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 07:56:59
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "renderer.h"
+
+namespace {
+
+/*
+ * test whether rectangles overlap, also when one of them has no width or height
+ */
+bool overlaps( const sf::FloatRect& a, const sf::FloatRect& b )
+{
+	return a.left <= b.left + b.width && b.left <= a.left + a.width
+		&& a.top <= b.top + b.height && b.top <= a.top + a.height;
+}
+
+}
+
+sf::Color Renderer::groupColor( const Segment& s )
+{
+	auto c = colors.find( s.getGroup() );
+	if( c != colors.end() )
+		return c->second;
+	return colors[ s.getGroup() ] = s.generateColor( s.getGroup() );
+}
+
+int Renderer::tileOf( const sf::Vector2f& p ) const
+{
+	int x = bounds.width > 0 ? (int)( ( p.x - bounds.left ) / bounds.width * TILES ) : 0;
+	int y = bounds.height > 0 ? (int)( ( p.y - bounds.top ) / bounds.height * TILES ) : 0;
+	x = std::min( TILES - 1, std::max( 0, x ) );
+	y = std::min( TILES - 1, std::max( 0, y ) );
+	return y * TILES + x;
+}
+
+void Renderer::findBounds( const std::vector<Segment>& segments )
+{
+	bounds = sf::FloatRect();
+	if( segments.empty() )
+		return;
+
+	float min_x = segments[0].getData()->x1, max_x = min_x;
+	float min_y = segments[0].getData()->y1, max_y = min_y;
+	for( auto& s : segments )
+	{
+		SegmentData *d = s.getData();
+		min_x = std::min( min_x, (float)std::min( d->x1, d->x2 ) );
+		max_x = std::max( max_x, (float)std::max( d->x1, d->x2 ) );
+		min_y = std::min( min_y, (float)std::min( d->y1, d->y2 ) );
+		max_y = std::max( max_y, (float)std::max( d->y1, d->y2 ) );
+	}
+	bounds = sf::FloatRect( min_x, min_y, max_x - min_x, max_y - min_y );
+}
+
+void Renderer::build( const std::vector<Segment>& segments, const std::vector<Intersection>& intersections )
+{
+	colors.clear();
+	findBounds( segments );
+
+	//every segment is a line, colors are generated once for every group
+	std::vector<sf::Vertex> vertices;
+	std::vector<float> sizes;
+	vertices.reserve( 2 * segments.size() );
+	sizes.reserve( segments.size() );
+	for( auto& s : segments )
+	{
+		SegmentData *d = s.getData();
+		sf::Color color = groupColor( s );
+		vertices.push_back( sf::Vertex( sf::Vector2f( d->x1, d->y1 ), color ) );
+		vertices.push_back( sf::Vertex( sf::Vector2f( d->x2, d->y2 ), color ) );
+		sizes.push_back( std::max( fabs( d->x2 - d->x1 ), fabs( d->y2 - d->y1 ) ) );
+	}
+	lines.type = sf::Lines;
+	lines.primitive_size = 2;
+	makeTiles( lines, vertices, sizes );
+
+	//every intersection is a square made of two triangles
+	vertices.clear();
+	sizes.clear();
+	float half = MARKER_SIZE / 2.0;
+	for( auto& p : intersections )
+	{
+		sf::Vector2f corners[4] = { sf::Vector2f( p.x - half, p.y - half ), sf::Vector2f( p.x + half, p.y - half ),
+			sf::Vector2f( p.x + half, p.y + half ), sf::Vector2f( p.x - half, p.y + half ) };
+		int order[6] = { 0, 1, 2, 0, 2, 3 };
+		for( int i = 0; i < 6; ++i )
+			vertices.push_back( sf::Vertex( corners[ order[i] ], sf::Color::Red ) );
+		sizes.push_back( MARKER_SIZE );
+	}
+	markers.type = sf::Triangles;
+	markers.primitive_size = 6;
+	makeTiles( markers, vertices, sizes );
+}
+
+void Renderer::makeTiles( Batch& batch, std::vector<sf::Vertex>& vertices, const std::vector<float>& sizes )
+{
+	unsigned int ps = batch.primitive_size;
+	unsigned int n = sizes.size();
+
+	//primitives of the same tile lie next to each other, the biggest ones first
+	std::vector<int> tile( n );
+	std::vector<unsigned int> order( n );
+	for( unsigned int i = 0; i < n; ++i )
+	{
+		tile[i] = tileOf( vertices[i * ps].position );
+		order[i] = i;
+	}
+	std::sort( order.begin(), order.end(), [&]( unsigned int a, unsigned int b )
+			{ return tile[a] == tile[b] ? sizes[a] > sizes[b] : tile[a] < tile[b]; } );
+
+	batch.vertices.clear();
+	batch.vertices.reserve( vertices.size() );
+	batch.sizes.clear();
+	batch.sizes.reserve( n );
+	batch.tiles.clear();
+	for( unsigned int i = 0; i < n; ++i )
+	{
+		unsigned int p = order[i];
+		if( batch.tiles.empty() || tile[p] != tile[ order[i - 1] ] ) {
+			Tile t;
+			t.bounds = sf::FloatRect( vertices[p * ps].position.x, vertices[p * ps].position.y, 0, 0 );
+			t.first = i;
+			t.count = 0;
+			batch.tiles.push_back( t );
+		}
+
+		//tile bounds grow to contain every primitive starting in it
+		Tile& t = batch.tiles.back();
+		for( unsigned int v = p * ps; v < ( p + 1 ) * ps; ++v )
+		{
+			const sf::Vector2f& pos = vertices[v].position;
+			float right = std::max( t.bounds.left + t.bounds.width, pos.x );
+			float bottom = std::max( t.bounds.top + t.bounds.height, pos.y );
+			t.bounds.left = std::min( t.bounds.left, pos.x );
+			t.bounds.top = std::min( t.bounds.top, pos.y );
+			t.bounds.width = right - t.bounds.left;
+			t.bounds.height = bottom - t.bounds.top;
+			batch.vertices.push_back( vertices[v] );
+		}
+		++t.count;
+		batch.sizes.push_back( sizes[p] );
+	}
+
+	//geometry doesn't change after building, so it can be kept in graphics memory
+	batch.use_buffer = false;
+	if( sf::VertexBuffer::isAvailable() && !batch.vertices.empty() ) {
+		batch.buffer.setPrimitiveType( batch.type );
+		batch.buffer.setUsage( sf::VertexBuffer::Static );
+		batch.use_buffer = batch.buffer.create( batch.vertices.size() ) && batch.buffer.update( batch.vertices.data() );
+	}
+}
+
+void Renderer::draw( sf::RenderWindow& window, const Batch& batch, const sf::FloatRect& visible, float min_size ) const
+{
+	unsigned int ps = batch.primitive_size;
+	unsigned int first = 0, count = 0;
+	auto flush = [&]() {
+		if( count == 0 )
+			return;
+		if( batch.use_buffer )
+			window.draw( batch.buffer, first * ps, count * ps );
+		else
+			window.draw( &batch.vertices[first * ps], count * ps, batch.type );
+		count = 0;
+	};
+
+	for( auto& t : batch.tiles )
+	{
+		if( !overlaps( t.bounds, visible ) )
+			continue;
+
+		//primitives are sorted from the biggest, so smaller than pixel are at the end of tile
+		auto begin = batch.sizes.begin() + t.first;
+		unsigned int visible_count = std::partition_point( begin, begin + t.count, [&]( float s )
+				{ return s >= min_size; } ) - begin;
+		if( visible_count == 0 )
+			continue;
+
+		//neighbouring tiles are joined into one draw call
+		if( count == 0 || first + count != t.first )
+			flush();
+		if( count == 0 )
+			first = t.first;
+		count += visible_count;
+		if( visible_count != t.count )
+			flush();
+	}
+	flush();
+}
+
+void Renderer::show( unsigned int width, unsigned int height, bool draw_markers )
+{
+	sf::RenderWindow window( sf::VideoMode( width, height ), "Planar visualization" );
+	sf::View view( sf::FloatRect( 0, 0, width, height ) );
+	//world units per pixel
+	float zoom = 1;
+	bool changed = true;
+	bool dragging = false;
+	sf::Vector2i drag;
+
+	while( window.isOpen() )
+	{
+		//frame is drawn only if something changed, otherwise window waits for events
+		if( changed ) {
+			window.setView( view );
+			window.clear();
+			sf::FloatRect visible( view.getCenter().x - view.getSize().x / 2, view.getCenter().y - view.getSize().y / 2,
+					view.getSize().x, view.getSize().y );
+			draw( window, lines, visible, zoom );
+			if( draw_markers )
+				draw( window, markers, visible, 0 );
+			window.display();
+			changed = false;
+		}
+
+		sf::Event event;
+		if( !window.waitEvent( event ) )
+			break;
+
+		switch( event.type )
+		{
+			case sf::Event::Closed:
+				window.close();
+				break;
+			case sf::Event::Resized:
+				view.setSize( event.size.width * zoom, event.size.height * zoom );
+				changed = true;
+				break;
+			case sf::Event::GainedFocus:
+				changed = true;
+				break;
+			case sf::Event::KeyPressed:
+			{
+				float step_x = view.getSize().x / 10, step_y = view.getSize().y / 10;
+				float factor = 1;
+				switch( event.key.code )
+				{
+					case sf::Keyboard::Left: view.move( -step_x, 0 ); break;
+					case sf::Keyboard::Right: view.move( step_x, 0 ); break;
+					case sf::Keyboard::Up: view.move( 0, -step_y ); break;
+					case sf::Keyboard::Down: view.move( 0, step_y ); break;
+					case sf::Keyboard::Add: factor = 0.8; break;
+					case sf::Keyboard::Subtract: factor = 1.25; break;
+					case sf::Keyboard::R:
+						zoom = 1;
+						view.setSize( window.getSize().x, window.getSize().y );
+						view.setCenter( window.getSize().x / 2.0, window.getSize().y / 2.0 );
+						break;
+					case sf::Keyboard::Escape: window.close(); break;
+					default: break;
+				}
+				zoom *= factor;
+				view.zoom( factor );
+				changed = true;
+				break;
+			}
+			case sf::Event::MouseWheelScrolled:
+			{
+				//point under cursor stays in place
+				float factor = event.mouseWheelScroll.delta > 0 ? 0.8 : 1.25;
+				sf::Vector2f c = view.getCenter();
+				float x = c.x + ( (float)event.mouseWheelScroll.x / window.getSize().x - 0.5 ) * view.getSize().x;
+				float y = c.y + ( (float)event.mouseWheelScroll.y / window.getSize().y - 0.5 ) * view.getSize().y;
+				view.setCenter( x + ( c.x - x ) * factor, y + ( c.y - y ) * factor );
+				zoom *= factor;
+				view.zoom( factor );
+				changed = true;
+				break;
+			}
+			case sf::Event::MouseButtonPressed:
+				if( event.mouseButton.button == sf::Mouse::Left ) {
+					dragging = true;
+					drag = sf::Vector2i( event.mouseButton.x, event.mouseButton.y );
+				}
+				break;
+			case sf::Event::MouseButtonReleased:
+				if( event.mouseButton.button == sf::Mouse::Left )
+					dragging = false;
+				break;
+			case sf::Event::MouseMoved:
+				if( dragging ) {
+					view.move( ( drag.x - event.mouseMove.x ) * zoom, ( drag.y - event.mouseMove.y ) * zoom );
+					drag = sf::Vector2i( event.mouseMove.x, event.mouseMove.y );
+					changed = true;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+bool Renderer::renderToFile( const std::vector<Segment>& segments, const std::vector<Intersection>& intersections,
+		unsigned int size, const std::string& path, int threads )
+{
+	colors.clear();
+	findBounds( segments );
+
+	//plane is scaled to fit the image, margin leaves place for markers on its edges
+	int margin = MARKER_SIZE;
+	size = std::max<unsigned int>( size, 2 * margin + 2 );
+	float extent = std::max( bounds.width, bounds.height );
+	float scale = extent > 0 ? ( size - 2 * margin - 1 ) / extent : 1;
+	unsigned int width = bounds.width * scale + 2 * margin + 1;
+	unsigned int height = bounds.height * scale + 2 * margin + 1;
+	auto pixel = [&]( double x, double y ) {
+		return sf::Vector2f( ( x - bounds.left ) * scale + margin, ( y - bounds.top ) * scale + margin );
+	};
+
+	//ends of segments in pixels, colors are generated before drawing as generator is not thread safe
+	std::vector<sf::Vector2f> ends;
+	std::vector<sf::Color> segment_colors;
+	ends.reserve( 2 * segments.size() );
+	segment_colors.reserve( segments.size() );
+	for( auto& s : segments )
+	{
+		SegmentData *d = s.getData();
+		ends.push_back( pixel( d->x1, d->y1 ) );
+		ends.push_back( pixel( d->x2, d->y2 ) );
+		segment_colors.push_back( groupColor( s ) );
+	}
+	std::vector<sf::Vector2i> centers;
+	centers.reserve( intersections.size() );
+	for( auto& p : intersections )
+	{
+		sf::Vector2f c = pixel( p.x, p.y );
+		centers.push_back( sf::Vector2i( lround( c.x ), lround( c.y ) ) );
+	}
+
+	//every segment and marker is assigned to every tile its bounding box covers
+	int tiles_x = ( width + IMAGE_TILE - 1 ) / IMAGE_TILE;
+	int tiles_y = ( height + IMAGE_TILE - 1 ) / IMAGE_TILE;
+	std::vector<std::vector<unsigned int> > tile_segments( tiles_x * tiles_y ), tile_markers( tiles_x * tiles_y );
+	auto assign = [&]( std::vector<std::vector<unsigned int> >& tiles, unsigned int i, float x1, float y1, float x2, float y2 ) {
+		int first_x = std::max( 0, (int)floor( x1 ) / IMAGE_TILE ), last_x = std::min( tiles_x - 1, (int)ceil( x2 ) / IMAGE_TILE );
+		int first_y = std::max( 0, (int)floor( y1 ) / IMAGE_TILE ), last_y = std::min( tiles_y - 1, (int)ceil( y2 ) / IMAGE_TILE );
+		for( int y = first_y; y <= last_y; ++y )
+			for( int x = first_x; x <= last_x; ++x )
+				tiles[ y * tiles_x + x ].push_back( i );
+	};
+	for( unsigned int i = 0; i < segments.size(); ++i )
+	{
+		const sf::Vector2f& p = ends[2 * i];
+		const sf::Vector2f& q = ends[2 * i + 1];
+		assign( tile_segments, i, std::min( p.x, q.x ), std::min( p.y, q.y ), std::max( p.x, q.x ), std::max( p.y, q.y ) );
+	}
+	for( unsigned int i = 0; i < centers.size(); ++i )
+	{
+		const sf::Vector2i& c = centers[i];
+		assign( tile_markers, i, c.x - MARKER_SIZE / 2, c.y - MARKER_SIZE / 2, c.x + MARKER_SIZE / 2, c.y + MARKER_SIZE / 2 );
+	}
+
+	//every pixel is written only by thread drawing its tile
+	std::vector<sf::Uint8> pixels( 4 * width * height, 0 );
+	for( unsigned int i = 3; i < pixels.size(); i += 4 )
+		pixels[i] = 255;
+
+	std::atomic<int> next_tile( 0 );
+	auto worker = [&]() {
+		int t;
+		while( ( t = next_tile++ ) < tiles_x * tiles_y )
+		{
+			int x0 = ( t % tiles_x ) * IMAGE_TILE, y0 = ( t / tiles_x ) * IMAGE_TILE;
+			int x1 = std::min<int>( x0 + IMAGE_TILE, width ), y1 = std::min<int>( y0 + IMAGE_TILE, height );
+			auto plot = [&]( long x, long y, const sf::Color& c ) {
+				if( x < x0 || x >= x1 || y < y0 || y >= y1 )
+					return;
+				sf::Uint8 *p = &pixels[ 4 * ( y * width + x ) ];
+				p[0] = c.r; p[1] = c.g; p[2] = c.b;
+			};
+
+			//lines are stepped along longer axis, pixel is computed the same way in every tile
+			for( unsigned int i : tile_segments[t] )
+			{
+				sf::Vector2f p = ends[2 * i], q = ends[2 * i + 1];
+				const sf::Color& c = segment_colors[i];
+				float dx = q.x - p.x, dy = q.y - p.y;
+				if( fabs( dx ) >= fabs( dy ) ) {
+					if( dx < 0 )
+						std::swap( p, q );
+					long first = std::max<long>( lround( p.x ), x0 ), last = std::min<long>( lround( q.x ), x1 - 1 );
+					if( fabs( dx ) < 1 ) {
+						plot( lround( p.x ), lround( p.y ), c );
+						continue;
+					}
+					for( long x = first; x <= last; ++x )
+						plot( x, lround( p.y + ( x - p.x ) * dy / dx ), c );
+				}
+				else {
+					if( dy < 0 )
+						std::swap( p, q );
+					long first = std::max<long>( lround( p.y ), y0 ), last = std::min<long>( lround( q.y ), y1 - 1 );
+					for( long y = first; y <= last; ++y )
+						plot( lround( p.x + ( y - p.y ) * dx / dy ), y, c );
+				}
+			}
+
+			//markers are drawn over segments
+			for( unsigned int i : tile_markers[t] )
+			{
+				for( int y = centers[i].y - MARKER_SIZE / 2; y <= centers[i].y + MARKER_SIZE / 2; ++y )
+					for( int x = centers[i].x - MARKER_SIZE / 2; x <= centers[i].x + MARKER_SIZE / 2; ++x )
+						plot( x, y, sf::Color::Red );
+			}
+		}
+	};
+
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+	std::vector<std::thread> workers;
+	for( int i = 1; i < threads; ++i )
+		workers.push_back( std::thread( worker ) );
+	worker();
+	for( auto& w : workers )
+		w.join();
+
+	sf::Image image;
+	image.create( width, height, pixels.data() );
+	return image.saveToFile( path );
+}
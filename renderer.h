@@ -0,0 +1,140 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  renderer.h
+ *
+ *    Description:  Rendering segments, intersections and components from batched, tiled vertex buffers
+ *    				to window or image file.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 07:56:59
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <SFML/Graphics.hpp>
+
+#include "segment.h"
+
+/*
+ * class drawing segments and intersections in a window
+ * geometry is built once after solving and divided into tiles of the plane,
+ * so only visible tiles are drawn and frame is drawn only when view changes
+ */
+class Renderer
+{
+public:
+	/*
+	 * number of tiles on every side of the plane
+	 */
+	static const int TILES = 64;
+	/*
+	 * size of marker drawn on intersection
+	 */
+	static const int MARKER_SIZE = 5;
+	/*
+	 * size of side of image tile rasterized by one thread at once
+	 */
+	static const int IMAGE_TILE = 256;
+
+	Renderer() {}
+
+	/*
+	 * build lines from given segments and markers from given intersections
+	 * previous content is removed
+	 */
+	void build( const std::vector<Segment>& segments, const std::vector<Intersection>& intersections );
+
+	/*
+	 * open window of given size and show built geometry until window is closed
+	 * arrows or dragging with mouse move the view, mouse wheel or +/- zoom it, R resets it
+	 */
+	void show( unsigned int width, unsigned int height, bool draw_markers );
+
+	/*
+	 * rasterize segments and intersection markers to image and save it to file, no window is opened
+	 * plane is scaled so longer side of image has given size, format of image is chosen by extension
+	 * tiles of image are drawn by given number of threads, if it is not positive number of hardware threads is used
+	 * return false if image couldn't be saved
+	 */
+	bool renderToFile( const std::vector<Segment>& segments, const std::vector<Intersection>& intersections,
+			unsigned int size, const std::string& path, int threads = 0 );
+
+	/*
+	 * get color of group of given segment, segments from the same group have the same color
+	 */
+	sf::Color groupColor( const Segment& s );
+
+private:
+	/*
+	 * continuous range of primitives lying in one tile of the plane
+	 */
+	struct Tile {
+		sf::FloatRect bounds;
+		unsigned int first, count;
+	};
+
+	/*
+	 * primitives of one kind divided into tiles
+	 * primitives of every tile are sorted from the biggest one
+	 */
+	struct Batch {
+		sf::PrimitiveType type;
+		unsigned int primitive_size;
+		std::vector<sf::Vertex> vertices;
+		sf::VertexBuffer buffer;
+		bool use_buffer;
+		std::vector<Tile> tiles;
+		/*
+		 * size of every primitive, used for skipping primitives smaller than pixel
+		 */
+		std::vector<float> sizes;
+	};
+
+	/*
+	 * find rectangle containing every segment
+	 */
+	void findBounds( const std::vector<Segment>& segments );
+
+	/*
+	 * divide primitives from vertices into tiles, primitive tile is chosen by its first vertex
+	 * and upload them to vertex buffer if it is available
+	 */
+	void makeTiles( Batch& batch, std::vector<sf::Vertex>& vertices, const std::vector<float>& sizes );
+
+	/*
+	 * draw every visible tile of batch skipping primitives smaller than given size
+	 */
+	void draw( sf::RenderWindow& window, const Batch& batch, const sf::FloatRect& visible, float min_size ) const;
+
+	/*
+	 * tile containing given point
+	 */
+	int tileOf( const sf::Vector2f& p ) const;
+
+	/*
+	 * lines of segments and squares of intersection markers
+	 */
+	Batch lines, markers;
+	/*
+	 * rectangle containing every segment, divided into tiles
+	 */
+	sf::FloatRect bounds;
+	/*
+	 * colors generated for groups of segments
+	 */
+	std::unordered_map<int, sf::Color> colors;
+};
+
+#endif
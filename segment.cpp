@@ -16,11 +16,19 @@
  *
  * =====================================================================================
  */
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
 #include "segment.h"
 
-int Segment::global_index = 0;
-double Segment::sweep_line = 0.0;
+thread_local int Segment::global_index = 0;
+thread_local double Segment::sweep_line = 0.0;
+thread_local double Segment::sweep_y = 0.0;
+thread_local bool Segment::sweep_before = false;
 const double precision = 0.0001;
+//it has to be much smaller than precision, otherwise segments crossing close to each other would be taken as crossing in one point
+const double sweep_precision = 0.000000001;
 
 //function for better doubles comparing
 bool equal(double a, double b, double epsilon)
@@ -40,27 +48,21 @@ Point::Point(double m_x, double m_y, Type m_t, SegmentData *m_owner, SegmentData
 //function used by priority queue and tree to compare points
 bool Point::cmp_point::operator()(const Point& p1, const Point& p2) const
 { 
-	//if points are the same they can't be smaller
-	if( p1.getNumber() == p2.getNumber() && p1.getType() == p2.getType() && p1.getOwner() == p2.getOwner() )
+	//points are compared exactly, so sweep line never moves back
+	//beginning of segment is always before its end
+	if( p1.x != p2.x )
+		return p1.x < p2.x;
+	if( p1.y != p2.y )
+		return p1.y < p2.y;
+
+	//in the same place crossings are handled first, then beginnings and ends
+	if( p1.t != p2.t )
+		return p1.t < p2.t;
+
+	//all crossings in the same place are single point
+	if( p1.t == CROSS )
 		return false;
-
-	//if points are from the same owner then
-	//beginning < cross < end
-	if( p1.getNumber() == p2.getNumber() ) {
-		if( p1.t != p2.t ) return p1.t < p2.t;
-	}
-	
-	//if comparing crossing and beginning or ending of its owner or intersection
-	//then beginning < cross < end
-	if( p1.getType() == CROSS && p1.getIntersection() == p2.getOwner() ) {
-		if( p1.t != p2.t ) return p1.t < p2.t;
-	}
-
-	if( p2.getType() == CROSS && p2.getIntersection() == p1.getOwner() ) {
-		if( p1.t != p2.t ) return p1.t < p2.t;
-	}
-	
-	return equal( p1.x, p2.x, precision ) ? smaller(p1.y, p2.y) : smaller(p1.x, p2.x); 
+	return p1.getNumber() < p2.getNumber();
 }
 
 
@@ -92,37 +94,43 @@ bool Segment::cmp_ptr::operator()(const Segment *s1, const Segment *s2) const
 {
 	if( s1->data->index == s2->data->index ) return false;
 
-	Point p1 = s1->sweepLineIntersection();
-	Point p2 = s2->sweepLineIntersection();
-
-	if( equal(p1.y, p2.y, precision) ) {
-		//vertical segment is always bigger
-		if( equal(s1->data->s_x, 0, precision) ) return false;
-		if( equal(s2->data->s_x, 0, precision) ) return true;
-	
-		//comparing is happening before swap
-		//so if we compare crossing of two points
-		//we can compare their beginnings
-		Point s1_beg = s1->getBeginning();
-
-		double old_sweep_line = sweep_line;
-		sweep_line = s1_beg.x;
-
-		p1 = s1->sweepLineIntersection();
-		p2 = s2->sweepLineIntersection();
-		sweep_line = old_sweep_line;
+	//keys are computed from lines of segments prepared when segments were created
+	double k1 = s1->sweepKey();
+	double k2 = s2->sweepKey();
+
+	if( !equal(k1, k2, s1->data->tolerance + s2->data->tolerance) )
+		return k1 < k2;
+
+	//segments meet in current point of sweep line
+	//order them as they are just after this point, or just before it
+	//vertical segment is the steepest one
+	bool v1 = s1->data->vertical;
+	bool v2 = s2->data->vertical;
+	if( v1 != v2 )
+		return sweep_before ? v1 : v2;
+
+	if( !v1 ) {
+		double a = s1->data->slope;
+		double b = s2->data->slope;
+		if( a != b )
+			return sweep_before ? a > b : a < b;
 	}
 
-	return p1.y < p2.y ;
+	//segments lie on the same line
+	return s1->data->number < s2->data->number;
 }
 
 
-Segment::Segment(double a, double b, double c, double d)
+Segment::Segment(double a, double b, double c, double d) : data(new SegmentData())
+{
+	assign(a, b, c, d);
+}
+
+void Segment::assign(double a, double b, double c, double d)
 {
-	data = new SegmentData();
 	//x1,y1 - beginning
 	//x2,y2 - end
-	if(a <= c)
+	if(a < c || (a == c && b <= d))
 	{
 		data->x1 = a; data->x2 = c;
 		data->y1 = b; data->y2 = d;
@@ -134,11 +142,19 @@ Segment::Segment(double a, double b, double c, double d)
 	}
 	data->s_x = data->x2 - data->x1;
 	data->s_y = data->y2 - data->y1;
+	//line of segment for ordering on sweep line
+	//error of x coordinate of sweep line is multiplied by slope, so steep segments need bigger tolerance
+	data->vertical = data->s_x == 0;
+	data->slope = data->vertical ? 0 : data->s_y / data->s_x;
+	data->tolerance = sweep_precision * ( 1 + fabs( data->slope ) );
 	data->color = sf::Color::White;
 	data->index = global_index++;
 	data->group = -1;
-	data->special_intersection = data->y1;
 	data->number = data->index;
+	data->layer = 0;
+	data->chain = -1;
+	data->run = -1;
+	data->neighbours.clear();
 }
 
 Segment::Segment( const Segment& s)
@@ -147,6 +163,16 @@ Segment::Segment( const Segment& s)
 	*data = *(s.data);
 }
 
+Segment& Segment::operator=( const Segment& s )
+{
+	if( this == &s )
+		return *this;
+	if( data == nullptr )
+		data = new SegmentData();
+	*data = *(s.data);
+	return *this;
+}
+
 void Segment::printInfo() const
 {
 	if( data == nullptr ) {
@@ -172,12 +198,19 @@ Segment Segment::generateSegment(double min, double max)
 }
 		
 Segment Segment::generateLengthSegment(double min, double max, double length)
+{
+	double x1, y1, x2, y2;
+	generateLengthCoordinates( min, max, length, x1, y1, x2, y2 );
+	return Segment(x1, y1, x2, y2);
+}
+
+void Segment::generateLengthCoordinates(double min, double max, double length, double& x1, double& y1, double& x2, double& y2)
 {
 	std::random_device rd;
 	std::default_random_engine e2(rd());
 	std::uniform_real_distribution<double> dist(min, max);
-	double x1 = dist(e2);
-	double y1 = dist(e2);
+	x1 = dist(e2);
+	y1 = dist(e2);
 
 	//try until segment won't fit into square
 	double x_shift, y_shift;
@@ -186,7 +219,8 @@ Segment Segment::generateLengthSegment(double min, double max, double length)
 		x_shift = dist_length(e2);
 		y_shift = dist_length(e2);
 	} while ( ( x1 + x_shift ) < min || ( x1 + x_shift ) > max || ( y1 + y_shift) < min || ( y1 + y_shift ) > max  );
-	return Segment(x1, y1, x1 + x_shift, y1 + y_shift );
+	x2 = x1 + x_shift;
+	y2 = y1 + y_shift;
 }
 
 Segment Segment::generateParallelSegment(const Segment& s, int range)
@@ -219,47 +253,112 @@ bool Segment::intersects(const Segment& s) const
 
 bool Segment::intersects(const Segment& s, double& x, double& y) const
 {
-	
-	double parallel = -s.data->s_x * data->s_y + data->s_x * s.data->s_y;
+	return segmentsIntersect( data->x1, data->y1, data->x2, data->y2,
+			s.data->x1, s.data->y1, s.data->x2, s.data->y2, x, y );
+}
+
+bool segmentsIntersect( double ax1, double ay1, double ax2, double ay2,
+		double bx1, double by1, double bx2, double by2, double& x, double& y )
+{
+	//segments sharing ending point always intersect, computing their crossing could lose it
+	if( ( ax1 == bx1 && ay1 == by1 ) || ( ax1 == bx2 && ay1 == by2 ) ) {
+		x = ax1; y = ay1;
+		return true;
+	}
+	if( ( ax2 == bx1 && ay2 == by1 ) || ( ax2 == bx2 && ay2 == by2 ) ) {
+		x = ax2; y = ay2;
+		return true;
+	}
+
+	double as_x = ax2 - ax1, as_y = ay2 - ay1;
+	double bs_x = bx2 - bx1, bs_y = by2 - by1;
+
+	double parallel = -bs_x * as_y + as_x * bs_y;
 	//two segments are parallel
 	if(parallel == 0)
 	{
-		double a_x, a_y;
-		a_x = s.data->x1 - data->x1;
-		a_y = s.data->y1 - data->y1;
-		//segments might be colinear
-		if( a_x * data->s_y - a_y * data->s_x == 0)
-		{
-			if( data->x1 >= s.data->x1 && data->x1 <= s.data->x2 )
-			{
-				x = data->x1; y = data->y1;
-				return true;
-			}
-			if( s.data->x1 >= data->x1 && s.data->x1 <= s.data->x2 )
-			{
-				x = s.data->x1; y = s.data->y1;
-				return true;
-			}
+		//direction of line, segment a might be a single point
+		double d_x = as_x, d_y = as_y;
+		if( d_x == 0 && d_y == 0 ) {
+			d_x = bs_x; d_y = bs_y;
+		}
+		//segments are not colinear
+		if( (bx1 - ax1) * d_y - (by1 - ay1) * d_x != 0 )
 			return false;
+
+		//segments are vertical, compare their ranges of y
+		if( d_x == 0 ) {
+			double low = std::max( std::min( ay1, ay2 ), std::min( by1, by2 ) );
+			double high = std::min( std::max( ay1, ay2 ), std::max( by1, by2 ) );
+			if( ax1 != bx1 || low > high )
+				return false;
+			x = ax1; y = low;
+			return true;
 		}
-		
 
+		//colinear segments intersect if one of them begins on the other
+		if( ax1 >= bx1 && ax1 <= bx2 )
+		{
+			x = ax1; y = ay1;
+			return true;
+		}
+		if( bx1 >= ax1 && bx1 <= ax2 )
+		{
+			x = bx1; y = by1;
+			return true;
+		}
+		return false;
 	}
 
 	double u,t;
-	u = (-data->s_y * (data->x1 - s.data->x1) + data->s_x * (data->y1 - s.data->y1) ) / ( -s.data->s_x * data->s_y + data->s_x * s.data->s_y) ;
-	t = ( s.data->s_x * (data->y1 - s.data->y1) - s.data->s_y * (data->x1 - s.data->x1)) / ( -s.data->s_x * data->s_y + data->s_x * s.data->s_y) ;
+	u = (-as_y * (ax1 - bx1) + as_x * (ay1 - by1) ) / parallel ;
+	t = ( bs_x * (ay1 - by1) - bs_y * (ax1 - bx1)) / parallel ;
 
 	//segments are not colinear and intersect
 	if(u >= 0 && u <= 1 && t >= 0 && t <= 1)
 	{
-		x = data->x1 + (t * data->s_x);
-		y = data->y1 + (t * data->s_y);
+		x = ax1 + (t * as_x);
+		y = ay1 + (t * as_y);
 		return true;
 	}
 	return false;
 }	
 
+/*
+ * squared distance of point from segment
+ */
+static double pointDistance2( double px, double py, double x1, double y1, double x2, double y2 )
+{
+	double dx = x2 - x1, dy = y2 - y1;
+	double length2 = dx * dx + dy * dy;
+	double t = length2 > 0 ? ( ( px - x1 ) * dx + ( py - y1 ) * dy ) / length2 : 0;
+	t = std::min( 1.0, std::max( 0.0, t ) );
+	double ex = x1 + t * dx - px, ey = y1 + t * dy - py;
+	return ex * ex + ey * ey;
+}
+
+double segmentsDistance( double ax1, double ay1, double ax2, double ay2,
+		double bx1, double by1, double bx2, double by2 )
+{
+	//intersection test needs beginnings on the left
+	if( ax2 < ax1 || ( ax2 == ax1 && ay2 < ay1 ) ) {
+		std::swap( ax1, ax2 );
+		std::swap( ay1, ay2 );
+	}
+	if( bx2 < bx1 || ( bx2 == bx1 && by2 < by1 ) ) {
+		std::swap( bx1, bx2 );
+		std::swap( by1, by2 );
+	}
+	double x, y;
+	if( segmentsIntersect( ax1, ay1, ax2, ay2, bx1, by1, bx2, by2, x, y ) )
+		return 0;
+
+	//segments not crossing are the closest at one of ending points
+	double d = std::min( pointDistance2( ax1, ay1, bx1, by1, bx2, by2 ), pointDistance2( ax2, ay2, bx1, by1, bx2, by2 ) );
+	d = std::min( d, std::min( pointDistance2( bx1, by1, ax1, ay1, ax2, ay2 ), pointDistance2( bx2, by2, ax1, ay1, ax2, ay2 ) ) );
+	return sqrt( d );
+}
+
 sf::Vertex *Segment::getVertexes()
 {	
 	data->color = generateColor(data->group);
@@ -286,19 +385,33 @@ sf::Color Segment::generateColor(int group) const
 
 Point Segment::sweepLineIntersection() const
 {
-	//segment is vertical - return special point
-	if( equal(data->s_x, 0, precision ) ) {
-		return Point(sweep_line, data->special_intersection, CROSS, data );
+	return Point(sweep_line, sweepKey(), CROSS, data );
+}
+
+double Segment::sweepKey() const
+{
+	//segment is vertical - it crosses sweep line in its current point
+	if( data->vertical ) {
+		return std::max( std::min( data->y1, data->y2 ), std::min( sweep_y, std::max( data->y1, data->y2 ) ) );
 	}
-	
-	double x = sweep_line;
-	double y = data->y1 + ( (x - data->x1) * data->s_y / data->s_x ) ;
-	return Point(x, y, CROSS, data );
+	return data->y1 + ( sweep_line - data->x1 ) * data->slope;
 }
 
-void Segment::setSpecialIntersection( Point p )
+bool Segment::samePoint( const Point& p1, const Point& p2 )
 {
-	data->special_intersection = p.y;
+	return equal( p1.x, p2.x, sweep_precision ) && equal( p1.y, p2.y, sweep_precision );
+}
+
+bool Segment::passesSweepPoint() const
+{
+	return equal( sweepKey(), sweep_y, data->tolerance );
+}
+
+bool Segment::colinear( const Segment& s ) const
+{
+	if( isVertical() || s.isVertical() )
+		return isVertical() && s.isVertical();
+	return data->slope == s.data->slope;
 }
 
 //swap segments data
@@ -311,4 +424,54 @@ void Segment::swap( Segment& s )
 	s.data = tmp;
 	s.data->index = data->index;
 	data->index = tmp_index;
-}
\ No newline at end of file
+}
+
+void sortEndpoints( const std::vector<Segment>& segments, std::vector<EndpointKey>& keys, std::vector<EndpointKey>& merged, int threads )
+{
+	keys.resize( 2 * segments.size() );
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+	//starting threads is not worth it for small number of segments
+	if( segments.size() < 65536 )
+		threads = 1;
+
+	//every thread creates keys of its part of segments and sorts them
+	auto part = [&]( int t ) { return 2 * ( segments.size() * t / threads ); };
+	auto fill = [&]( int t ) {
+		for( size_t i = part(t) / 2; i < part(t + 1) / 2; ++i )
+		{
+			SegmentData *d = segments[i].getData();
+			EndpointKey beginning = { d->x1, d->y1, BEGINNING, d->number, d };
+			EndpointKey end = { d->x2, d->y2, END, d->number, d };
+			keys[2 * i] = beginning;
+			keys[2 * i + 1] = end;
+		}
+		std::sort( keys.begin() + part(t), keys.begin() + part(t + 1) );
+	};
+	std::vector<std::thread> workers;
+	for( int t = 1; t < threads; ++t )
+		workers.push_back( std::thread( fill, t ) );
+	fill( 0 );
+	for( auto& w : workers )
+		w.join();
+
+	//sorted parts are merged in pairs until one is left, every pair is merged by its own thread
+	if( threads > 1 )
+		merged.resize( keys.size() );
+	for( int width = 1; width < threads; width *= 2 )
+	{
+		workers.clear();
+		for( int t = 0; t < threads; t += 2 * width )
+		{
+			size_t first = part(t);
+			size_t middle = part( std::min( t + width, threads ) );
+			size_t last = part( std::min( t + 2 * width, threads ) );
+			workers.push_back( std::thread( [&keys, &merged, first, middle, last]() {
+					std::merge( keys.begin() + first, keys.begin() + middle, keys.begin() + middle, keys.begin() + last, merged.begin() + first );
+				} ) );
+		}
+		for( auto& w : workers )
+			w.join();
+		keys.swap( merged );
+	}
+}
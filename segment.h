@@ -16,6 +16,9 @@
  *
  * =====================================================================================
  */
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
 #include <stdlib.h>
 #include <iostream>
 #include <random>
@@ -29,14 +32,39 @@
 
 /*
  * types of points: beginning, crossing or ending
+ * types are numbered in order points lying in the same place are handled
  */
-enum Type  { BEGINNING = 1, CROSS = 2, END = 3 };
+enum Type  { CROSS = 1, BEGINNING = 2, END = 3 };
 
 /*
  * functions used for better comparing double values
  */
 bool smaller( double a, double b, double epsilon = 0.0001 );
 bool equal(double a, double b, double epsilon = 0.0001 );
+/*
+ * segments closer to each other on sweep line pass through the same point
+ */
+extern const double sweep_precision;
+
+/*
+ * test whether two segments given by coordinates of their ending points intersect
+ * write coordinates of intersection into given variables
+ */
+bool segmentsIntersect( double ax1, double ay1, double ax2, double ay2,
+		double bx1, double by1, double bx2, double by2, double& x, double& y );
+/*
+ * get distance between two segments given by coordinates of their ending points, zero if they intersect
+ */
+double segmentsDistance( double ax1, double ay1, double ax2, double ay2,
+		double bx1, double by1, double bx2, double by2 );
+
+/*
+ * intersection of two segments, given by its coordinates and numbers of crossing segments
+ */
+struct Intersection {
+	double x, y;
+	int s1, s2;
+};
 
 /*
  * struct holding segments data
@@ -69,9 +97,13 @@ struct SegmentData {
 	 */
 	double s_x, s_y;
 	/*
-	 * special value used for comparing crossing points of vertical segments in Bentley-Ottman algorithm
+	 * line of segment used for ordering segments on sweep line: y = y1 + ( x - x1 ) * slope
+	 * vertical segments have no slope, they cross sweep line in its current point
+	 * tolerance is distance from point of sweep line at which segment still passes through it
 	 */
-	double special_intersection;
+	double slope;
+	bool vertical;
+	double tolerance;
 	/*
 	 * vector of data of segments intersecting with this segment
 	 */
@@ -96,6 +128,16 @@ struct SegmentData {
 	 * unique number representing segment
 	 */
 	int number;
+	/*
+	 * layer this segment comes from, used for reporting only crossings between chosen layers
+	 */
+	int layer;
+	/*
+	 * polyline or polygon ring this segment is edge of and its x-monotone run, -1 for single segment
+	 * edges of one run lie one after another along x, so they touch only in shared vertices
+	 */
+	int chain;
+	int run;
 };
 
 /*
@@ -173,6 +215,37 @@ public:
 	SegmentData *intersection;
 };
 
+/*
+ * beginning or end of segment packed for sorting
+ * fields used for comparing are kept inline, so sorting doesn't touch segments
+ */
+struct EndpointKey {
+	double x, y;
+	int type;
+	int number;
+	SegmentData *owner;
+
+	/*
+	 * keys are ordered the same way as points by Point::cmp_point
+	 */
+	bool operator<( const EndpointKey& k ) const
+	{
+		if( x != k.x )
+			return x < k.x;
+		if( y != k.y )
+			return y < k.y;
+		if( type != k.type )
+			return type < k.type;
+		return number < k.number;
+	}
+
+	/*
+	 * get point represented by this key
+	 */
+	Point toPoint() const
+	{ return Point( x, y, (Type)type, owner ); }
+};
+
 /*
  * class representing single segment on a plane
  * provides static methods for generating new segments
@@ -186,8 +259,22 @@ public:
 	Segment() : data(new SegmentData) {};
 	Segment(double, double, double, double);	
 	Segment(const Segment&);
+	/*
+	 * moved segment takes data of the other one, which is left empty
+	 */
+	Segment(Segment&& s) noexcept : data(s.data) { s.data = nullptr; }
 	~Segment() { if ( data != nullptr ) delete data; }
 
+	Segment& operator=(const Segment&);
+	Segment& operator=(Segment&& s) noexcept
+	{ std::swap( data, s.data ); return *this; }
+
+	/*
+	 * give segment new coordinates and index as if it was created again
+	 * memory of its data and list of neighbours is kept, so segments can be reused without allocating
+	 */
+	void assign(double, double, double, double);
+
 	/*
 	 * test whether two segments intersect
 	 * write coordinates of intersection into given variables
@@ -206,6 +293,10 @@ public:
 	 * and with length no bigger than specified ( Manhattan metrics )
 	 */
 	static Segment generateLengthSegment(double min, double max, double length);
+	/*
+	 * generate coordinates of such segment without creating it
+	 */
+	static void generateLengthCoordinates(double min, double max, double length, double& x1, double& y1, double& x2, double& y2);
 	/*
 	 * generate segment parallel to the given segment
 	 * that lays no further than range
@@ -279,15 +370,69 @@ public:
 	 */
 	void setGroup(int g);
 
+	/*
+	 * get layer of this segment
+	 */
+	int getLayer() const
+	{ return data->layer; }
+
+	/*
+	 * set layer of this segment
+	 */
+	void setLayer( int l )
+	{ data->layer = l; }
+
+	/*
+	 * get polyline this segment is edge of, -1 for single segment
+	 */
+	int getChain() const
+	{ return data->chain; }
+	/*
+	 * get x-monotone run of polyline this segment lies in, -1 for single segment
+	 */
+	int getRun() const
+	{ return data->run; }
+	/*
+	 * set polyline and its x-monotone run this segment is edge of
+	 */
+	void setChain( int c, int r )
+	{ data->chain = c; data->run = r; }
+
 	/*
 	 * get Point representing intersection of this segment with current sweep line
 	 */
 	Point sweepLineIntersection() const;
+	/*
+	 * return whether segment passes through current point of sweep line
+	 */
+	bool passesSweepPoint() const;
+	/*
+	 * get y coordinate of intersection of this segment with current sweep line
+	 */
+	double sweepKey() const;
+	/*
+	 * get distance from point of sweep line at which segment still passes through it
+	 * crossing of steep segment with sweep line is computed with lower precision
+	 */
+	double sweepTolerance() const
+	{ return data->tolerance; }
+	/*
+	 * return whether points are so close that sweep line takes them as the same point
+	 */
+	static bool samePoint( const Point&, const Point& );
 	/*
 	 * set sweep line coordinate
+	 * sweep line is slightly rotated, so it reaches points with the same x from the lowest one
+	 * vertical segments cross it in current point of the sweep line
 	 */
 	static void setSweepLine( const Point& p)
-	{ sweep_line = p.x; }
+	{ sweep_line = p.x; sweep_y = p.y; }
+	/*
+	 * set whether segments meeting in current point of sweep line are ordered
+	 * as just before this point or as just after it
+	 */
+	static void setSweepBefore( bool before )
+	{ sweep_before = before; }
 
 	/*
 	 * swap data of two segments
@@ -296,16 +441,16 @@ public:
 	void swap( Segment& );
 
 	/*
-	 * set special intersection value used for comparing points
-	 * of crossing with horizontal segments
+	 * return whether segment lies on the same line as given one
 	 */
-	void setSpecialIntersection( Point );
+	bool colinear( const Segment& ) const;
 
 	/*
 	 * return whether segment is vertical
+	 * almost vertical segments are not, they would break order of points on sweep line
 	 */
 	bool isVertical() const
-	{ return equal(data->s_x, 0, 0.0001); }
+	{ return data->vertical; }
 
 	/*
 	 * get pointer to segment data
@@ -330,12 +475,25 @@ private:
 	SegmentData *data;
 	/*
 	 * global variable used for calculating new indices of segments
+	 * it is kept for every thread, so threads can create and solve their own segments at once
 	 */
-	static int global_index;
+	static thread_local int global_index;
 	/*
-	 * current coordinate od sweep line
+	 * current coordinate od sweep line and current point on it, every thread sweeps its own line
 	 */
-	static double sweep_line;
+	static thread_local double sweep_line;
+	static thread_local double sweep_y;
+	/*
+	 * indicate segments meeting in current point are ordered as before it
+	 */
+	static thread_local bool sweep_before;
 };
 
+/*
+ * write sorted beginnings and ends of every segment into keys, merged is buffer for merging sorted parts
+ * keys are created and sorted by given number of threads, if it is not positive number of hardware threads is used
+ * memory of both vectors is reused, so passing the same ones again doesn't allocate
+ */
+void sortEndpoints( const std::vector<Segment>& segments, std::vector<EndpointKey>& keys, std::vector<EndpointKey>& merged, int threads = 0 );
 
+#endif
@@ -0,0 +1,458 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  server.cpp
+ *
+ *    Description:  Server keeping sets of segments between requests of clients connecting to Unix domain socket.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:27:56
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.h"
+
+SolverServer::SolverServer( const PlanarIntersections& c, int t ) : context( c ), threads( t ), choose_solvers( false ), next_set( 1 ),
+	listen_fd( -1 ), stopping( false ), requests_count( 0 )
+{
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+bool SolverServer::serve( const std::string& path )
+{
+	sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	if( path.size() >= sizeof( address.sun_path ) )
+		return false;
+	strcpy( address.sun_path, path.c_str() );
+
+	int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( fd < 0 )
+		return false;
+	unlink( path.c_str() );
+	if( bind( fd, (sockaddr*)&address, sizeof( address ) ) < 0 || listen( fd, 64 ) < 0 ) {
+		close( fd );
+		return false;
+	}
+	listen_fd = fd;
+	stopping = false;
+	requests_count = 0;
+
+	//every thread serves one connection at a time, reusing its buffers for every request
+	auto worker = [&]() {
+		Buffers buffers;
+		while( true )
+		{
+			std::unique_lock<std::mutex> lock( queue_lock );
+			queue_ready.wait( lock, [&]() { return stopping || !waiting.empty(); } );
+			if( stopping )
+				return;
+			int client = waiting.back();
+			waiting.pop_back();
+			serving.insert( client );
+			lock.unlock();
+
+			serveClient( client, buffers );
+
+			lock.lock();
+			serving.erase( client );
+			close( client );
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for( int t = 0; t < threads; ++t )
+		workers.push_back( std::thread( worker ) );
+
+	//accepting stops when listening socket is shut down by stop request
+	while( true )
+	{
+		int client = accept( fd, nullptr, nullptr );
+		if( client < 0 ) {
+			if( errno == EINTR || errno == ECONNABORTED )
+				continue;
+			break;
+		}
+		std::lock_guard<std::mutex> lock( queue_lock );
+		if( stopping ) {
+			close( client );
+			break;
+		}
+		waiting.push_back( client );
+		queue_ready.notify_one();
+	}
+
+	stop();
+	for( auto& w : workers )
+		w.join();
+	for( int client : waiting )
+		close( client );
+	waiting.clear();
+	close( fd );
+	unlink( path.c_str() );
+	return true;
+}
+
+void SolverServer::stop()
+{
+	std::lock_guard<std::mutex> lock( queue_lock );
+	stopping = true;
+	//threads waiting for requests of connected clients are woken by shutting their connections down
+	shutdown( listen_fd, SHUT_RDWR );
+	for( int client : serving )
+		shutdown( client, SHUT_RDWR );
+	queue_ready.notify_all();
+}
+
+void SolverServer::serveClient( int fd, Buffers& buffers )
+{
+	RequestHeader header;
+	while( receiveAll( fd, &header, sizeof( header ) ) )
+	{
+		buffers.response.clear();
+		ServerStatus status = STATUS_BAD_REQUEST;
+		if( header.size <= MAX_PAYLOAD ) {
+			buffers.request.resize( header.size );
+			if( header.size > 0 && !receiveAll( fd, buffers.request.data(), header.size ) )
+				return;
+			status = handle( header, buffers );
+		}
+		++requests_count;
+
+		ResponseHeader response = { (uint32_t)status, (uint32_t)buffers.response.size() };
+		if( !sendAll( fd, &response, sizeof( response ) ) || !sendAll( fd, buffers.response.data(), buffers.response.size() ) )
+			return;
+		//too big payload can't be skipped, so connection is closed
+		if( header.size > MAX_PAYLOAD )
+			return;
+		if( header.command == SHUTDOWN_SERVER && status == STATUS_OK ) {
+			stop();
+			return;
+		}
+	}
+}
+
+ServerStatus SolverServer::handle( const RequestHeader& header, Buffers& buffers )
+{
+	const char *payload = buffers.request.data();
+	uint32_t size = header.size;
+	std::vector<char>& response = buffers.response;
+
+	if( header.command == CREATE_SET ) {
+		std::lock_guard<std::mutex> lock( sets_lock );
+		unsigned int id = next_set++;
+		std::shared_ptr<SegmentSet> set = std::make_shared<SegmentSet>( context );
+		//server needs crossings of segments and reports crossings of every segment
+		set->solver.setCountOnly( false );
+		set->solver.setRecordIntersections( false );
+		set->solver.setAdjacencyStructure( LIST_ADJACENCY );
+		set->solver.clearLayers();
+		sets[id] = set;
+		put<uint32_t>( response, id );
+		return STATUS_OK;
+	}
+	if( header.command == SHUTDOWN_SERVER )
+		return STATUS_OK;
+	if( header.command == DROP_SET ) {
+		std::lock_guard<std::mutex> lock( sets_lock );
+		return sets.erase( header.set ) ? STATUS_OK : STATUS_NO_SET;
+	}
+
+	std::shared_ptr<SegmentSet> found = findSet( header.set );
+	if( !found )
+		return STATUS_NO_SET;
+	SegmentSet& set = *found;
+	std::lock_guard<std::mutex> lock( set.lock );
+
+	switch( header.command )
+	{
+	case INSERT_SEGMENTS: {
+		if( size % ( 4 * sizeof( double ) ) != 0 )
+			return STATUS_BAD_REQUEST;
+		uint32_t first = set.removed.size(), count = size / ( 4 * sizeof( double ) );
+		std::vector<double>& c = set.coordinates;
+		for( uint32_t i = 0; i < count; ++i )
+		{
+			//payload is not aligned, so coordinates are copied before use
+			c.resize( c.size() + 4 );
+			memcpy( &c[ c.size() - 4 ], payload + 4 * sizeof( double ) * i, 4 * sizeof( double ) );
+			insertSegment( set, &c[ c.size() - 4 ], buffers );
+		}
+		put( response, first );
+		put( response, count );
+		return STATUS_OK;
+	}
+	case REMOVE_SEGMENTS: {
+		if( size % sizeof( uint32_t ) != 0 )
+			return STATUS_BAD_REQUEST;
+		uint32_t removed = 0;
+		for( uint32_t i = 0; i < size / sizeof( uint32_t ); ++i )
+		{
+			uint32_t id;
+			memcpy( &id, payload + sizeof( uint32_t ) * i, sizeof( id ) );
+			if( removeSegment( set, id ) )
+				++removed;
+		}
+		put( response, removed );
+		return STATUS_OK;
+	}
+	case SOLVE_SET: {
+		if( size != 0 )
+			return STATUS_BAD_REQUEST;
+		auto start = std::chrono::steady_clock::now();
+		if( !solveSet( set ) )
+			return STATUS_FAILED;
+		double time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+		std::vector<int>& roots = buffers.found;
+		roots.clear();
+		for( unsigned int id = 0; id < set.removed.size(); ++id )
+		{
+			if( !set.removed[id] )
+				roots.push_back( set.components.find( id ) );
+		}
+		std::sort( roots.begin(), roots.end() );
+		uint32_t components = std::unique( roots.begin(), roots.end() ) - roots.begin();
+		put<int64_t>( response, set.intersections );
+		put( response, components );
+		put( response, time );
+		return STATUS_OK;
+	}
+	case QUERY_SEGMENT:
+	case QUERY_WINDOW: {
+		if( size != 4 * sizeof( double ) )
+			return STATUS_BAD_REQUEST;
+		double c[4];
+		memcpy( c, payload, sizeof( c ) );
+		if( !solveSet( set ) )
+			return STATUS_FAILED;
+		querySet( set, header.command == QUERY_SEGMENT ? IndexQuery::SEGMENT : IndexQuery::WINDOW, c, buffers );
+		return STATUS_OK;
+	}
+	case SEGMENT_CROSSINGS: {
+		uint32_t id;
+		if( size != sizeof( id ) )
+			return STATUS_BAD_REQUEST;
+		memcpy( &id, payload, sizeof( id ) );
+		if( id >= set.removed.size() )
+			return STATUS_BAD_REQUEST;
+		if( !solveSet( set ) )
+			return STATUS_FAILED;
+		for( uint32_t other : set.crossings[id] )
+			put( response, other );
+		return STATUS_OK;
+	}
+	case SEGMENT_COMPONENTS: {
+		if( size % sizeof( uint32_t ) != 0 )
+			return STATUS_BAD_REQUEST;
+		if( !solveSet( set ) )
+			return STATUS_FAILED;
+		//component is given by id of one of its segments
+		for( uint32_t i = 0; i < size / sizeof( uint32_t ); ++i )
+		{
+			uint32_t id;
+			memcpy( &id, payload + sizeof( uint32_t ) * i, sizeof( id ) );
+			bool exists = id < set.removed.size() && !set.removed[id];
+			put<int32_t>( response, exists ? set.components.find( id ) : -1 );
+		}
+		return STATUS_OK;
+	}
+	default:
+		return STATUS_BAD_REQUEST;
+	}
+}
+
+std::shared_ptr<SolverServer::SegmentSet> SolverServer::findSet( unsigned int id )
+{
+	std::lock_guard<std::mutex> lock( sets_lock );
+	auto itr = sets.find( id );
+	if( itr == sets.end() )
+		return std::shared_ptr<SegmentSet>();
+	return itr->second;
+}
+
+bool SolverServer::solveSet( SegmentSet& set )
+{
+	if( !set.solved ) {
+		PlanarIntersections& solver = set.solver;
+		solver.reset();
+		set.ids.clear();
+		for( unsigned int id = 0; id < set.removed.size(); ++id )
+		{
+			if( set.removed[id] )
+				continue;
+			const double *c = &set.coordinates[4 * id];
+			solver.addSegment( c[0], c[1], c[2], c[3] );
+			set.ids.push_back( id );
+		}
+		if( set.alive > 0 ) {
+			if( choose_solvers )
+				solver.chooseSolvers();
+			if( !solver.solve() )
+				return false;
+		}
+		solver.buildIndex();
+
+		//neighbours of segments are kept by their numbers, which are positions of segments in order of adding
+		for( auto& list : set.crossings )
+			list.clear();
+		set.crossings.resize( set.removed.size() );
+		for( auto& s : solver.getSegments() )
+		{
+			std::vector<unsigned int>& list = set.crossings[ set.ids[ s.getData()->number ] ];
+			for( SegmentData *n : s.getData()->neighbours )
+				list.push_back( set.ids[ n->number ] );
+			std::sort( list.begin(), list.end() );
+			list.erase( std::unique( list.begin(), list.end() ), list.end() );
+		}
+		set.intersections = 0;
+		for( auto& list : set.crossings )
+			set.intersections += list.size();
+		set.intersections /= 2;
+		set.pending.clear();
+		set.pending_ids.clear();
+		set.solved = true;
+		set.components_valid = false;
+	}
+
+	if( !set.components_valid ) {
+		set.components = DisjointSet( set.removed.size() );
+		for( unsigned int id = 0; id < set.crossings.size(); ++id )
+		{
+			for( unsigned int other : set.crossings[id] )
+				set.components.makeUnion( id, other );
+		}
+		set.components_valid = true;
+	}
+	return true;
+}
+
+void SolverServer::insertSegment( SegmentSet& set, const double *c, Buffers& buffers )
+{
+	unsigned int id = set.removed.size();
+	set.removed.push_back( false );
+	++set.alive;
+	if( !set.solved )
+		return;
+
+	//too many inserted segments are cheaper to solve again than to test with each other
+	if( (int)set.pending.size() >= MAX_PENDING ) {
+		set.solved = false;
+		return;
+	}
+
+	set.crossings.push_back( std::vector<unsigned int>() );
+	set.components.add();
+	std::vector<int>& found = buffers.found;
+	found.clear();
+	set.solver.getIndex().querySegment( c[0], c[1], c[2], c[3], found );
+	auto& segments = set.solver.getSegments();
+	for( int slot : found )
+	{
+		unsigned int other = set.ids[ segments[slot].getData()->number ];
+		if( !set.removed[other] )
+			link( set, id, other );
+	}
+
+	Segment s( c[0], c[1], c[2], c[3] );
+	for( unsigned int i = 0; i < set.pending.size(); ++i )
+	{
+		double x, y;
+		if( !set.removed[ set.pending_ids[i] ] && s.intersects( set.pending[i], x, y ) )
+			link( set, id, set.pending_ids[i] );
+	}
+	set.pending.push_back( s );
+	set.pending_ids.push_back( id );
+
+	//inserted segment has the biggest id, so only its own list has to be sorted
+	std::sort( set.crossings[id].begin(), set.crossings[id].end() );
+}
+
+bool SolverServer::removeSegment( SegmentSet& set, unsigned int id )
+{
+	if( id >= set.removed.size() || set.removed[id] )
+		return false;
+	set.removed[id] = true;
+	--set.alive;
+	if( !set.solved )
+		return true;
+
+	//removing segment may split its component, so components are found again
+	for( unsigned int other : set.crossings[id] )
+	{
+		auto& list = set.crossings[other];
+		list.erase( std::lower_bound( list.begin(), list.end(), id ) );
+	}
+	set.intersections -= set.crossings[id].size();
+	std::vector<unsigned int>().swap( set.crossings[id] );
+	set.components_valid = false;
+	return true;
+}
+
+void SolverServer::link( SegmentSet& set, unsigned int a, unsigned int b )
+{
+	set.crossings[a].push_back( b );
+	set.crossings[b].push_back( a );
+	set.components.makeUnion( a, b );
+	++set.intersections;
+}
+
+void SolverServer::querySet( SegmentSet& set, IndexQuery::QueryType type, const double *c, Buffers& buffers )
+{
+	std::vector<int>& found = buffers.found;
+	found.clear();
+	if( type == IndexQuery::SEGMENT )
+		set.solver.getIndex().querySegment( c[0], c[1], c[2], c[3], found );
+	else
+		set.solver.getIndex().queryWindow( c[0], c[1], c[2], c[3], found );
+	auto& segments = set.solver.getSegments();
+	for( int slot : found )
+	{
+		uint32_t id = set.ids[ segments[slot].getData()->number ];
+		if( !set.removed[id] )
+			put( buffers.response, id );
+	}
+
+	//inserted segments are not in index
+	double min_x = std::min( c[0], c[2] ), max_x = std::max( c[0], c[2] );
+	double min_y = std::min( c[1], c[3] ), max_y = std::max( c[1], c[3] );
+	for( unsigned int i = 0; i < set.pending.size(); ++i )
+	{
+		uint32_t id = set.pending_ids[i];
+		if( set.removed[id] )
+			continue;
+		const double *p = &set.coordinates[4 * id];
+		double x, y;
+		bool hit;
+		if( type == IndexQuery::SEGMENT ) {
+			hit = segmentsIntersect( p[0], p[1], p[2], p[3], c[0], c[1], c[2], c[3], x, y );
+		}
+		else {
+			hit = ( p[0] >= min_x && p[0] <= max_x && p[1] >= min_y && p[1] <= max_y )
+				|| ( p[2] >= min_x && p[2] <= max_x && p[3] >= min_y && p[3] <= max_y )
+				|| segmentsIntersect( p[0], p[1], p[2], p[3], min_x, min_y, max_x, min_y, x, y )
+				|| segmentsIntersect( p[0], p[1], p[2], p[3], min_x, max_y, max_x, max_y, x, y )
+				|| segmentsIntersect( p[0], p[1], p[2], p[3], min_x, min_y, min_x, max_y, x, y )
+				|| segmentsIntersect( p[0], p[1], p[2], p[3], max_x, min_y, max_x, max_y, x, y );
+		}
+		if( hit )
+			put( buffers.response, id );
+	}
+}
@@ -0,0 +1,195 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  server.h
+ *
+ *    Description:  Server keeping sets of segments between requests of clients connecting to Unix domain socket.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:27:56
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "planarIntersections.h"
+#include "disjoint.h"
+#include "protocol.h"
+
+/*
+ * long running server keeping sets of segments with their solutions and indices between requests
+ * clients connect to Unix domain socket and send requests in binary protocol described in protocol.h
+ * connections are served by fixed pool of threads, requests for different sets run at the same time
+ */
+class SolverServer
+{
+public:
+	/*
+	 * server using given number of threads, if it is not positive number of hardware threads is used
+	 * context sets how sets are solved, its segments are not used
+	 */
+	SolverServer( const PlanarIntersections& context, int threads = 0 );
+
+	/*
+	 * set choosing solvers for every set separately by probing its segments
+	 */
+	void setChooseSolvers( bool c )
+	{ choose_solvers = c; }
+
+	/*
+	 * listen on socket of given path and serve clients until shutdown request
+	 * existing file of that path is removed, return false if socket can't be created
+	 */
+	bool serve( const std::string& path );
+
+	/*
+	 * get number of requests served by last call
+	 */
+	long long getRequestsCount() const
+	{ return requests_count; }
+
+	/*
+	 * number of segments inserted into solved set after which it is solved again instead of testing them with each other
+	 */
+	static const int MAX_PENDING = 256;
+
+private:
+	/*
+	 * segments kept by server, identified by ids given in order of inserting
+	 * set is solved lazily by first request needing solution, later changes update its crossings
+	 * segments inserted into solved set are tested with index of solved segments and with other inserted ones
+	 * removed segments are left in index and skipped by queries, components are found again from crossings
+	 */
+	struct SegmentSet {
+		std::mutex lock;
+		/*
+		 * coordinates of every segment ever inserted and whether it was removed
+		 */
+		std::vector<double> coordinates;
+		std::vector<bool> removed;
+		int alive;
+		/*
+		 * solver holding solved segments with their index and id of each of them by its number
+		 */
+		PlanarIntersections solver;
+		std::vector<unsigned int> ids;
+		bool solved;
+		/*
+		 * segments inserted after solving and their ids
+		 */
+		std::vector<Segment> pending;
+		std::vector<unsigned int> pending_ids;
+		/*
+		 * ids of segments crossing every segment and components of segments
+		 */
+		std::vector<std::vector<unsigned int> > crossings;
+		DisjointSet components;
+		bool components_valid;
+		long long intersections;
+
+		SegmentSet( const PlanarIntersections& context ) : alive( 0 ), solver( context ), solved( false ), components( 0 ), components_valid( false ), intersections( 0 )
+		{}
+	};
+
+	/*
+	 * buffers of one thread reused for every request it serves
+	 */
+	struct Buffers {
+		std::vector<char> request;
+		std::vector<char> response;
+		std::vector<int> found;
+	};
+
+	/*
+	 * serve requests of connected client until it disconnects
+	 */
+	void serveClient( int fd, Buffers& buffers );
+	/*
+	 * handle single request, write its payload into response and return status
+	 */
+	ServerStatus handle( const RequestHeader& header, Buffers& buffers );
+
+	/*
+	 * get set of given id, empty pointer if there is no such set
+	 */
+	std::shared_ptr<SegmentSet> findSet( unsigned int id );
+
+	/*
+	 * solve segments of set if it is not solved and find its components if they changed
+	 * return false if solving failed, set has to be locked
+	 */
+	bool solveSet( SegmentSet& set );
+	/*
+	 * insert segment to set, if it is solved crossings of segment are found at once
+	 */
+	void insertSegment( SegmentSet& set, const double *c, Buffers& buffers );
+	/*
+	 * remove segment of given id from set and from crossings of other segments
+	 */
+	bool removeSegment( SegmentSet& set, unsigned int id );
+	/*
+	 * find ids of segments of solved set crossing segment or lying in window, result is written to response
+	 */
+	void querySet( SegmentSet& set, IndexQuery::QueryType type, const double *c, Buffers& buffers );
+	/*
+	 * add both segments to crossings of each other
+	 */
+	void link( SegmentSet& set, unsigned int a, unsigned int b );
+
+	/*
+	 * stop accepting connections and wake every thread
+	 */
+	void stop();
+
+	/*
+	 * append value to response
+	 */
+	template<class T>
+	void put( std::vector<char>& response, const T& value )
+	{
+		const char *p = (const char*)&value;
+		response.insert( response.end(), p, p + sizeof( T ) );
+	}
+
+	/*
+	 * configured context copied by every set
+	 */
+	const PlanarIntersections& context;
+	int threads;
+	bool choose_solvers;
+
+	/*
+	 * sets of segments by their ids
+	 */
+	std::mutex sets_lock;
+	std::map<unsigned int, std::shared_ptr<SegmentSet> > sets;
+	unsigned int next_set;
+
+	/*
+	 * accepted connections waiting for thread, connections being served and listening socket
+	 */
+	std::mutex queue_lock;
+	std::condition_variable queue_ready;
+	std::vector<int> waiting;
+	std::set<int> serving;
+	int listen_fd;
+	bool stopping;
+	std::atomic<long long> requests_count;
+};
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  spatialIndex.cpp
+ *
+ *    Description:  Packed R-tree index of segments answering segment, window and distance queries.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 07:38:56
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "spatialIndex.h"
+
+void SpatialIndex::clear()
+{
+	entries.clear();
+	boxes.clear();
+	level_offsets.clear();
+}
+
+void SpatialIndex::build( const std::vector<Segment>& segments )
+{
+	clear();
+	if( segments.empty() )
+		return;
+
+	entries.reserve( segments.size() );
+	for( auto& s : segments )
+	{
+		SegmentData *d = s.getData();
+		Entry e = { d->x1, d->y1, d->x2, d->y2, s.getIndex() };
+		entries.push_back( e );
+	}
+
+	//sort-tile-recursive: cut plane into vertical slices by x of centers
+	//then sort every slice by y, so every leaf holds close segments
+	int leaves = ( entries.size() + NODE_SIZE - 1 ) / NODE_SIZE;
+	int slices = (int)ceil( sqrt( (double)leaves ) );
+	unsigned int slice_size = slices * NODE_SIZE;
+
+	std::sort( entries.begin(), entries.end(), []( const Entry& a, const Entry& b )
+			{ return a.x1 + a.x2 < b.x1 + b.x2; } );
+	for( unsigned int i = 0; i < entries.size(); i += slice_size )
+	{
+		auto last = i + slice_size < entries.size() ? entries.begin() + i + slice_size : entries.end();
+		std::sort( entries.begin() + i, last, []( const Entry& a, const Entry& b )
+				{ return a.y1 + a.y2 < b.y1 + b.y2; } );
+	}
+
+	//boxes of single segments form lowest level
+	for( auto& e : entries )
+	{
+		Box b = { std::min( e.x1, e.x2 ), std::min( e.y1, e.y2 ), std::max( e.x1, e.x2 ), std::max( e.y1, e.y2 ) };
+		boxes.push_back( b );
+	}
+	level_offsets.push_back( 0 );
+
+	//every next level has box for every NODE_SIZE boxes from level below
+	int begin = 0, end = boxes.size();
+	while( end - begin > 1 )
+	{
+		level_offsets.push_back( end );
+		for( int i = begin; i < end; i += NODE_SIZE )
+		{
+			Box b = boxes[i];
+			for( int j = i + 1; j < end && j < i + NODE_SIZE; ++j )
+			{
+				b.min_x = std::min( b.min_x, boxes[j].min_x );
+				b.min_y = std::min( b.min_y, boxes[j].min_y );
+				b.max_x = std::max( b.max_x, boxes[j].max_x );
+				b.max_y = std::max( b.max_y, boxes[j].max_y );
+			}
+			boxes.push_back( b );
+		}
+		begin = end;
+		end = boxes.size();
+	}
+	level_offsets.push_back( boxes.size() );
+}
+
+template<class Test>
+void SpatialIndex::search( const Box& query, Test test, std::vector<int>& result ) const
+{
+	if( entries.empty() )
+		return;
+
+	//pairs of level and index of node on this level waiting for visit
+	std::vector<std::pair<int, int> > stack;
+	int top_level = level_offsets.size() - 2;
+	stack.push_back( std::make_pair( top_level, 0 ) );
+	while( !stack.empty() )
+	{
+		int level = stack.back().first;
+		int node = stack.back().second;
+		stack.pop_back();
+
+		if( !boxes[level_offsets[level] + node].overlaps( query ) )
+			continue;
+
+		if( level == 0 ) {
+			if( test( entries[node] ) )
+				result.push_back( entries[node].index );
+			continue;
+		}
+
+		int level_size = level_offsets[level] - level_offsets[level - 1];
+		for( int i = node * NODE_SIZE; i < level_size && i < ( node + 1 ) * NODE_SIZE; ++i )
+		{
+			stack.push_back( std::make_pair( level - 1, i ) );
+		}
+	}
+}
+
+void SpatialIndex::querySegment( double x1, double y1, double x2, double y2, std::vector<int>& result ) const
+{
+	Box query = { std::min( x1, x2 ), std::min( y1, y2 ), std::max( x1, x2 ), std::max( y1, y2 ) };
+	//segments are tested against query with the same test solvers use
+	//so index gives the same answers as adding query segment and solving again
+	if( x2 < x1 ) {
+		std::swap( x1, x2 );
+		std::swap( y1, y2 );
+	}
+	search( query, [&]( const Entry& e ) {
+			double x, y;
+			return segmentsIntersect( e.x1, e.y1, e.x2, e.y2, x1, y1, x2, y2, x, y );
+		}, result );
+}
+
+void SpatialIndex::queryWindow( double x1, double y1, double x2, double y2, std::vector<int>& result ) const
+{
+	Box query = { std::min( x1, x2 ), std::min( y1, y2 ), std::max( x1, x2 ), std::max( y1, y2 ) };
+	search( query, [&]( const Entry& e ) {
+			//one of ending points lies inside the window
+			if( e.x1 >= query.min_x && e.x1 <= query.max_x && e.y1 >= query.min_y && e.y1 <= query.max_y )
+				return true;
+			if( e.x2 >= query.min_x && e.x2 <= query.max_x && e.y2 >= query.min_y && e.y2 <= query.max_y )
+				return true;
+
+			//otherwise segment has to cross one of the window sides
+			double x, y;
+			return segmentsIntersect( e.x1, e.y1, e.x2, e.y2, query.min_x, query.min_y, query.max_x, query.min_y, x, y )
+				|| segmentsIntersect( e.x1, e.y1, e.x2, e.y2, query.min_x, query.max_y, query.max_x, query.max_y, x, y )
+				|| segmentsIntersect( e.x1, e.y1, e.x2, e.y2, query.min_x, query.min_y, query.min_x, query.max_y, x, y )
+				|| segmentsIntersect( e.x1, e.y1, e.x2, e.y2, query.max_x, query.min_y, query.max_x, query.max_y, x, y );
+		}, result );
+}
+
+void SpatialIndex::queryDistance( double x1, double y1, double x2, double y2, double distance, std::vector<int>& result ) const
+{
+	//boxes of segments close enough overlap box of query grown by distance
+	Box query = { std::min( x1, x2 ) - distance, std::min( y1, y2 ) - distance, std::max( x1, x2 ) + distance, std::max( y1, y2 ) + distance };
+	search( query, [&]( const Entry& e ) {
+			return segmentsDistance( e.x1, e.y1, e.x2, e.y2, x1, y1, x2, y2 ) <= distance;
+		}, result );
+}
+
+void SpatialIndex::batchQuery( const std::vector<IndexQuery>& queries, std::vector<std::vector<int> >& results, int threads ) const
+{
+	results.assign( queries.size(), std::vector<int>() );
+	if( threads <= 0 )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+	threads = std::min<int>( threads, queries.size() );
+
+	//every thread answers every threads-th query, index is not modified so no locking is needed
+	auto worker = [&]( int first ) {
+		for( unsigned int i = first; i < queries.size(); i += threads )
+		{
+			const IndexQuery& q = queries[i];
+			if( q.type == IndexQuery::SEGMENT )
+				querySegment( q.x1, q.y1, q.x2, q.y2, results[i] );
+			else
+				queryWindow( q.x1, q.y1, q.x2, q.y2, results[i] );
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for( int t = 1; t < threads; ++t )
+		workers.push_back( std::thread( worker, t ) );
+	if( threads > 0 )
+		worker( 0 );
+	for( auto& w : workers )
+		w.join();
+}
+
+void SpatialIndex::crossingsOfVertical( const std::vector<Segment>& segments, const std::vector<int>& vertical,
+		const std::function<void( int, int, double, double )>& report ) const
+{
+	std::vector<int> found;
+	for( int v : vertical )
+	{
+		SegmentData *d = segments[v].getData();
+		found.clear();
+		querySegment( d->x1, d->y1, d->x2, d->y2, found );
+		for( int s : found )
+		{
+			//crossing of two vertical segments is reported only by one of them
+			if( s == v || ( segments[s].isVertical() && s < v ) )
+				continue;
+			double x, y;
+			segments[v].intersects( segments[s], x, y );
+			report( v, s, x, y );
+		}
+	}
+}
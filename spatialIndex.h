@@ -0,0 +1,141 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  spatialIndex.h
+ *
+ *    Description:  Packed R-tree index of segments answering segment, window and distance queries.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 07:38:56
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <functional>
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * query used for batched searching of index
+ * segment query asks for segments crossing segment (x1, y1) - (x2, y2)
+ * window query asks for segments lying in rectangle with corners (x1, y1) and (x2, y2)
+ */
+struct IndexQuery {
+	enum QueryType { SEGMENT, WINDOW };
+
+	QueryType type;
+	double x1, y1, x2, y2;
+};
+
+/*
+ * packed R-tree bulk-loaded from segments with Sort-Tile-Recursive method
+ * once built it is read only, so it can be searched from many threads at once
+ */
+class SpatialIndex
+{
+public:
+	/*
+	 * number of children of every node of the tree
+	 */
+	static const int NODE_SIZE = 16;
+
+	SpatialIndex() {}
+
+	/*
+	 * build index from given segments, clears previous content
+	 * indices returned by queries are indices of segments in given vector
+	 */
+	void build( const std::vector<Segment>& segments );
+
+	/*
+	 * remove every segment from index
+	 */
+	void clear();
+
+	/*
+	 * return whether index holds no segments
+	 */
+	bool empty() const
+	{ return entries.empty(); }
+
+	/*
+	 * find indices of segments intersecting segment (x1, y1) - (x2, y2)
+	 * found indices are appended to result
+	 */
+	void querySegment( double x1, double y1, double x2, double y2, std::vector<int>& result ) const;
+	/*
+	 * find indices of segments which have at least one point inside given rectangle
+	 * found indices are appended to result
+	 */
+	void queryWindow( double x1, double y1, double x2, double y2, std::vector<int>& result ) const;
+	/*
+	 * find indices of segments lying no further than given distance from segment (x1, y1) - (x2, y2)
+	 * found indices are appended to result
+	 */
+	void queryDistance( double x1, double y1, double x2, double y2, double distance, std::vector<int>& result ) const;
+
+	/*
+	 * answer every query from given vector using specified number of threads
+	 * results[i] holds answer for queries[i]
+	 * if threads is not positive number of hardware threads is used
+	 */
+	void batchQuery( const std::vector<IndexQuery>& queries, std::vector<std::vector<int> >& results, int threads = 0 ) const;
+
+	/*
+	 * call report with indices and crossing point for every segment crossing one of given vertical segments
+	 * index has to be built from given segments, crossing of two vertical segments is reported once
+	 * used by solvers dividing plane by x coordinates, vertical segments have no width for them
+	 */
+	void crossingsOfVertical( const std::vector<Segment>& segments, const std::vector<int>& vertical,
+			const std::function<void( int, int, double, double )>& report ) const;
+
+private:
+	/*
+	 * bounding box of a node or of a single segment
+	 */
+	struct Box {
+		double min_x, min_y, max_x, max_y;
+
+		bool overlaps( const Box& b ) const
+		{ return min_x <= b.max_x && b.min_x <= max_x && min_y <= b.max_y && b.min_y <= max_y; }
+	};
+
+	/*
+	 * leaf entry keeping coordinates of segment inline, so exact tests don't touch segments vector
+	 */
+	struct Entry {
+		double x1, y1, x2, y2;
+		int index;
+	};
+
+	/*
+	 * visit every leaf entry which bounding box overlaps given box
+	 * and append index of entries accepted by test to result
+	 */
+	template<class Test>
+	void search( const Box& query, Test test, std::vector<int>& result ) const;
+
+	/*
+	 * leaf entries in order of tree leaves
+	 */
+	std::vector<Entry> entries;
+	/*
+	 * boxes of every level of the tree, starting with boxes of leaf entries
+	 * children of box i on level l are boxes NODE_SIZE * i ... NODE_SIZE * i + NODE_SIZE - 1 on level l - 1
+	 */
+	std::vector<Box> boxes;
+	/*
+	 * index of first box of every level in boxes vector, last value is size of boxes vector
+	 */
+	std::vector<int> level_offsets;
+};
+
+#endif
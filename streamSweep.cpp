@@ -0,0 +1,89 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  streamSweep.cpp
+ *
+ *    Description:  Sweep of segments streamed in order of their smaller x coordinate, keeping only segments
+ *    				crossing sweep line in memory.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:45:33
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <cmath>
+#include <limits>
+
+#include "streamSweep.h"
+
+StreamSweep::StreamSweep( double h ) : band_height( h ), sweep_x( std::numeric_limits<double>::lowest() ), segments_count( 0 )
+{
+	if( band_height > 0 )
+		sweeper.reset( BANDS, band_height );
+}
+
+void StreamSweep::setReporter( const Reporter& r )
+{
+	sweeper.setReporter( [r]( long long a, long long b, double x, double y ) { r( a, b, x, y ); return true; } );
+}
+
+bool StreamSweep::addSegment( double a, double b, double c, double d )
+{
+	//x1,y1 - beginning
+	//x2,y2 - end
+	BandedSweep::Record r;
+	if( a < c || ( a == c && b <= d ) ) {
+		r.x1 = a; r.y1 = b; r.x2 = c; r.y2 = d;
+	}
+	else {
+		r.x1 = c; r.y1 = d; r.x2 = a; r.y2 = b;
+	}
+	if( r.x1 < sweep_x )
+		return false;
+	sweep_x = r.x1;
+	r.index = segments_count++;
+
+	if( band_height <= 0 ) {
+		lookahead.push_back( r );
+		if( lookahead.size() >= LOOKAHEAD )
+			flushLookahead();
+		return true;
+	}
+	sweeper.closeBefore( r.x1 );
+	sweeper.open( r );
+	return true;
+}
+
+void StreamSweep::finish()
+{
+	if( band_height <= 0 )
+		flushLookahead();
+	sweeper.closeBefore( std::numeric_limits<double>::infinity() );
+}
+
+void StreamSweep::flushLookahead()
+{
+	//band is as high as average segment, so most segments lie in one or two bands
+	//segments much higher than first ones are kept apart by banded sweep
+	double height = 0, width = 0;
+	for( auto& r : lookahead )
+	{
+		height += fabs( r.y2 - r.y1 );
+		width += r.x2 - r.x1;
+	}
+	band_height = height > 0 ? height : width;
+	band_height = band_height > 0 ? band_height / lookahead.size() : 1;
+	sweeper.reset( BANDS, band_height );
+
+	for( auto& r : lookahead )
+	{
+		sweeper.closeBefore( r.x1 );
+		sweeper.open( r );
+	}
+	std::vector<BandedSweep::Record>().swap( lookahead );
+}
@@ -0,0 +1,118 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  streamSweep.h
+ *
+ *    Description:  Sweep of segments streamed in order of their smaller x coordinate, keeping only segments
+ *    				crossing sweep line in memory.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 09:45:33
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef STREAM_SWEEP_H
+#define STREAM_SWEEP_H
+
+#include <functional>
+#include <vector>
+
+#include "bandedSweep.h"
+
+/*
+ * class solving intersections of segments given already sorted by their beginnings, that is smaller x coordinate
+ * every added segment moves sweep line to its beginning, segments ending before it are closed and forgotten
+ * opened segments are kept by banded sweep, so memory depends on number of segments crossing sweep line,
+ * not on number of all segments
+ */
+class StreamSweep
+{
+public:
+	/*
+	 * function called for every found intersection with numbers of crossing segments and coordinates of crossing
+	 */
+	typedef std::function<void( long long, long long, double, double )> Reporter;
+
+	/*
+	 * number of first segments used for choosing height of bands
+	 */
+	static const int LOOKAHEAD = 1024;
+	/*
+	 * number of lists keeping bands, far bands share them
+	 */
+	static const int BANDS = 1024;
+
+	/*
+	 * create solver with bands of given height, if it is not positive it is chosen from first segments
+	 */
+	StreamSweep( double band_height = 0 );
+
+	/*
+	 * set function called for every found intersection
+	 */
+	void setReporter( const Reporter& r );
+
+	/*
+	 * add next segment and find its crossings with opened segments
+	 * return false if it begins before previous segment, then it is not added
+	 */
+	bool addSegment( double, double, double, double );
+	/*
+	 * close every opened segment after last segment was added
+	 */
+	void finish();
+
+	/*
+	 * get number of added segments
+	 */
+	long long getSegmentsCount() const
+	{ return segments_count; }
+	/*
+	 * get number of intersections found so far
+	 */
+	long long getIntersectionsCount() const
+	{ return sweeper.getIntersectionsCount(); }
+	/*
+	 * get number of connected components whose every segment is closed
+	 */
+	long long getComponentsCount() const
+	{ return sweeper.getComponentsCount(); }
+	/*
+	 * get maximal number of segments opened at once
+	 */
+	long long getMaxOpened() const
+	{ return sweeper.getMaxOpened(); }
+	/*
+	 * get height of bands of y coordinates
+	 */
+	double getBandHeight() const
+	{ return band_height; }
+
+private:
+	/*
+	 * choose height of bands from first segments and sweep them
+	 */
+	void flushLookahead();
+
+	/*
+	 * first segments waiting until height of bands is chosen
+	 */
+	std::vector<BandedSweep::Record> lookahead;
+	double band_height;
+	/*
+	 * opened segments and their components
+	 */
+	BandedSweep sweeper;
+	/*
+	 * beginning of last added segment
+	 */
+	double sweep_x;
+	long long segments_count;
+};
+
+#endif
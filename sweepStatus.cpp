@@ -0,0 +1,275 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  sweepStatus.cpp
+ *
+ *    Description:  Implementing Ottman-Bentley algorithm for fiding intersections of segments on a plane and then finding connected graphs among them.
+ *    				Also allowsuser to compare different methods of finding intersections and connected graph components.
+ *
+ *        Version:  1.0
+ *        Created:  06.11.2016 13:58:40
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include "sweepStatus.h"
+
+bool TreeStatus::find( Segment *s, Position& p )
+{
+	//segments meeting in current point are searched in order from before it first
+	Segment::setSweepBefore( true );
+	p = tree.find( s );
+	Segment::setSweepBefore( false );
+	if( p == tree.end() )
+		p = tree.find( s );
+	return p != tree.end();
+}
+
+void TreeStatus::reverse( Position first, Position last )
+{
+	std::vector<Segment*> crossing;
+	for( Position itr = first; itr != std::next(last); ++itr )
+	{
+		crossing.push_back( *itr );
+	}
+
+	//tree can't change order of its segments, so their data is swapped instead
+	for( unsigned int i = 0; i < crossing.size() / 2; ++i )
+	{
+		crossing[i]->swap( *crossing[ crossing.size() - 1 - i ] );
+	}
+	//colinear segments don't change their order, move them back
+	Segment::cmp_ptr cmp;
+	for( unsigned int i = 1; i < crossing.size(); ++i )
+	{
+		for( unsigned int j = i; j > 0 && cmp( crossing[j], crossing[j - 1] ); --j )
+		{
+			crossing[j]->swap( *crossing[j - 1] );
+		}
+	}
+}
+
+void BlockStatus::reset( int segments_count )
+{
+	blocks.clear();
+	free_blocks.clear();
+	order.clear();
+	fences.clear();
+	Position none = { -1, -1 };
+	where.assign( segments_count, none );
+}
+
+BlockStatus::Entry BlockStatus::makeEntry( Segment *s )
+{
+	SegmentData *d = s->getData();
+	Entry e;
+	e.x1 = d->x1;
+	e.y1 = d->y1;
+	e.vertical = d->vertical;
+	e.slope = d->slope;
+	e.low = std::min( d->y1, d->y2 );
+	e.high = std::max( d->y1, d->y2 );
+	e.tolerance = d->tolerance;
+	e.number = d->number;
+	e.segment = s;
+	return e;
+}
+
+bool BlockStatus::below( const Entry& a, double ka, const Entry& b, double kb )
+{
+	if( !equal( ka, kb, a.tolerance + b.tolerance ) )
+		return ka < kb;
+
+	//entries meet in current point, vertical one is the steepest
+	if( a.vertical != b.vertical )
+		return b.vertical;
+	if( !a.vertical && a.slope != b.slope )
+		return a.slope < b.slope;
+
+	//entries lie on the same line
+	return a.number < b.number;
+}
+
+int BlockStatus::createBlock( int rank )
+{
+	int id;
+	if( free_blocks.empty() ) {
+		id = blocks.size();
+		blocks.push_back( Block() );
+	}
+	else {
+		id = free_blocks.back();
+		free_blocks.pop_back();
+	}
+
+	//link block between blocks of neighbouring ranks
+	Block& b = blocks[id];
+	b.entries.clear();
+	b.entries.reserve( 2 * BLOCK_SIZE + 1 );
+	b.prev = rank > 0 ? order[rank - 1] : -1;
+	b.next = rank < (int)order.size() ? order[rank] : -1;
+	if( b.prev != -1 )
+		blocks[b.prev].next = id;
+	if( b.next != -1 )
+		blocks[b.next].prev = id;
+
+	order.insert( order.begin() + rank, id );
+	fences.insert( fences.begin() + rank, Entry() );
+	for( unsigned int r = rank; r < order.size(); ++r )
+		blocks[ order[r] ].rank = r;
+	return id;
+}
+
+void BlockStatus::removeBlock( int id )
+{
+	Block& b = blocks[id];
+	if( b.prev != -1 )
+		blocks[b.prev].next = b.next;
+	if( b.next != -1 )
+		blocks[b.next].prev = b.prev;
+
+	order.erase( order.begin() + b.rank );
+	fences.erase( fences.begin() + b.rank );
+	for( unsigned int r = b.rank; r < order.size(); ++r )
+		blocks[ order[r] ].rank = r;
+	free_blocks.push_back( id );
+}
+
+void BlockStatus::update( int id, int from )
+{
+	Block& b = blocks[id];
+	for( unsigned int i = from; i < b.entries.size(); ++i )
+	{
+		Position p = { id, (int)i };
+		where[ b.entries[i].segment->getIndex() ] = p;
+	}
+	if( !b.entries.empty() )
+		fences[b.rank] = b.entries.back();
+}
+
+BlockStatus::Position BlockStatus::insert( Segment *s )
+{
+	Entry e = makeEntry( s );
+	double k = key( e );
+
+	if( order.empty() )
+		createBlock( 0 );
+
+	//find first block which last entry lies above new one, or the last block
+	int low = 0, high = order.size() - 1;
+	while( low < high )
+	{
+		int middle = ( low + high ) / 2;
+		if( below( fences[middle], key( fences[middle] ), e, k ) )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	int id = order[low];
+
+	//find place in block
+	std::vector<Entry>& entries = blocks[id].entries;
+	int offset = std::partition_point( entries.begin(), entries.end(), [&]( const Entry& other )
+			{ return below( other, key( other ), e, k ); } ) - entries.begin();
+	entries.insert( entries.begin() + offset, e );
+	update( id, offset );
+
+	//block is too big, move its second half into new block
+	if( entries.size() > 2 * BLOCK_SIZE ) {
+		int half = BLOCK_SIZE;
+		int created = createBlock( blocks[id].rank + 1 );
+		std::vector<Entry>& moved = blocks[id].entries;
+		blocks[created].entries.assign( moved.begin() + half, moved.end() );
+		moved.erase( moved.begin() + half, moved.end() );
+		update( id, half );
+		update( created );
+	}
+	return where[ s->getIndex() ];
+}
+
+void BlockStatus::erase( Position p )
+{
+	int id = p.block;
+	std::vector<Entry>& entries = blocks[id].entries;
+	Position none = { -1, -1 };
+	where[ entries[p.offset].segment->getIndex() ] = none;
+	entries.erase( entries.begin() + p.offset );
+
+	if( entries.empty() ) {
+		removeBlock( id );
+		return;
+	}
+	update( id, p.offset );
+
+	//small block is joined with next one if they fit into one block
+	int next = blocks[id].next;
+	if( next != -1 && entries.size() < BLOCK_SIZE / 4 && entries.size() + blocks[next].entries.size() <= BLOCK_SIZE ) {
+		int from = entries.size();
+		entries.insert( entries.end(), blocks[next].entries.begin(), blocks[next].entries.end() );
+		blocks[next].entries.clear();
+		removeBlock( next );
+		update( id, from );
+	}
+}
+
+BlockStatus::Position BlockStatus::prev( Position p ) const
+{
+	if( p.offset > 0 ) {
+		--p.offset;
+		return p;
+	}
+	p.block = blocks[p.block].prev;
+	p.offset = blocks[p.block].entries.size() - 1;
+	return p;
+}
+
+BlockStatus::Position BlockStatus::next( Position p ) const
+{
+	if( p.offset + 1 < (int)blocks[p.block].entries.size() ) {
+		++p.offset;
+		return p;
+	}
+	p.block = blocks[p.block].next;
+	p.offset = 0;
+	return p;
+}
+
+void BlockStatus::reverse( Position first, Position last )
+{
+	std::vector<Position> crossing;
+	for( Position p = first; ; p = next( p ) )
+	{
+		crossing.push_back( p );
+		if( p == last )
+			break;
+	}
+	auto entry = [&]( int i ) -> Entry& {
+		return blocks[ crossing[i].block ].entries[ crossing[i].offset ];
+	};
+
+	//entries are reversed in place, so positions of run don't change
+	for( unsigned int i = 0; i < crossing.size() / 2; ++i )
+	{
+		std::swap( entry( i ), entry( crossing.size() - 1 - i ) );
+	}
+	//colinear entries don't change their order, move them back
+	for( unsigned int i = 1; i < crossing.size(); ++i )
+	{
+		for( unsigned int j = i; j > 0 && below( entry( j ), key( entry( j ) ), entry( j - 1 ), key( entry( j - 1 ) ) ); --j )
+		{
+			std::swap( entry( j ), entry( j - 1 ) );
+		}
+	}
+
+	for( unsigned int i = 0; i < crossing.size(); ++i )
+	{
+		where[ entry( i ).segment->getIndex() ] = crossing[i];
+		Block& b = blocks[ crossing[i].block ];
+		if( crossing[i].offset + 1 == (int)b.entries.size() )
+			fences[b.rank] = b.entries.back();
+	}
+}
@@ -0,0 +1,240 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  sweepStatus.h
+ *
+ *    Description:  Implementing Ottman-Bentley algorithm for fiding intersections of segments on a plane and then finding connected graphs among them.
+ *    				Also allowsuser to compare different methods of finding intersections and connected graph components.
+ *
+ *        Version:  1.0
+ *        Created:  06.11.2016 13:58:40
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef SWEEP_STATUS_H
+#define SWEEP_STATUS_H
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * structures keeping segments crossing sweep line in Bentley-Ottman algorithm, ordered from the lowest one
+ * both provide the same operations, so algorithm can use any of them:
+ * inserting segment, finding and erasing it, moving to neighbours of segment
+ * and reversing order of segments crossing in current point of sweep line
+ */
+
+/*
+ * status kept in red-black tree of segments
+ * segments are compared by Segment::cmp_ptr, reversing swaps data of segments
+ */
+class TreeStatus
+{
+public:
+	typedef std::set<Segment*, Segment::cmp_ptr>::iterator Position;
+
+	/*
+	 * remove every segment, status will hold segments with indices lower than given number
+	 */
+	void reset( int )
+	{ tree.clear(); }
+
+	/*
+	 * set point of sweep line segments are ordered in
+	 */
+	void setSweepPoint( const Point& p )
+	{ Segment::setSweepLine( p ); }
+
+	/*
+	 * insert segment and return its position
+	 */
+	Position insert( Segment *s )
+	{ return tree.insert( s ).first; }
+	/*
+	 * find position of segment, return false if it can't be found
+	 * segments meeting in current point might be still ordered as before it
+	 */
+	bool find( Segment *s, Position& p );
+	/*
+	 * erase segment from given position
+	 */
+	void erase( Position p )
+	{ tree.erase( p ); }
+
+	/*
+	 * return whether there is segment below or above given position
+	 */
+	bool hasPrev( Position p ) const
+	{ return p != tree.begin(); }
+	bool hasNext( Position p ) const
+	{ return std::next( p ) != tree.end(); }
+	/*
+	 * get position of segment below or above given position
+	 */
+	Position prev( Position p ) const
+	{ return std::prev( p ); }
+	Position next( Position p ) const
+	{ return std::next( p ); }
+
+	/*
+	 * get segment from given position
+	 */
+	Segment *at( Position p ) const
+	{ return *p; }
+	/*
+	 * return whether segment from given position passes through current point of sweep line
+	 */
+	bool passesSweepPoint( Position p ) const
+	{ return (*p)->passesSweepPoint(); }
+
+	/*
+	 * reverse order of segments from first to last position, they cross in current point of sweep line
+	 * colinear segments keep their order
+	 */
+	void reverse( Position first, Position last );
+
+	bool empty() const
+	{ return tree.empty(); }
+
+private:
+	std::set<Segment*, Segment::cmp_ptr> tree;
+};
+
+/*
+ * status kept in sorted array divided into linked blocks, like leaves of B+ tree
+ * every entry keeps line of segment inline, so comparing doesn't touch segments
+ * last entries of blocks are kept together in fences array, which is searched first
+ * position of every segment is remembered, so finding segment doesn't need comparing at all
+ */
+class BlockStatus
+{
+public:
+	/*
+	 * number of entries in block, blocks twice as big are split
+	 */
+	static const int BLOCK_SIZE = 64;
+
+	/*
+	 * block and place of entry in this block
+	 */
+	struct Position {
+		int block, offset;
+
+		bool operator==( const Position& p ) const
+		{ return block == p.block && offset == p.offset; }
+	};
+
+	BlockStatus() : sweep_x(0), sweep_y(0) {}
+
+	void reset( int segments_count );
+
+	void setSweepPoint( const Point& p )
+	{ sweep_x = p.x; sweep_y = p.y; }
+
+	Position insert( Segment *s );
+	bool find( Segment *s, Position& p ) const
+	{ p = where[ s->getIndex() ]; return p.block != -1; }
+	void erase( Position p );
+
+	bool hasPrev( Position p ) const
+	{ return p.offset > 0 || blocks[p.block].prev != -1; }
+	bool hasNext( Position p ) const
+	{ return p.offset + 1 < (int)blocks[p.block].entries.size() || blocks[p.block].next != -1; }
+	Position prev( Position p ) const;
+	Position next( Position p ) const;
+
+	Segment *at( Position p ) const
+	{ return blocks[p.block].entries[p.offset].segment; }
+	bool passesSweepPoint( Position p ) const
+	{ return equal( key( blocks[p.block].entries[p.offset] ), sweep_y, blocks[p.block].entries[p.offset].tolerance ); }
+
+	void reverse( Position first, Position last );
+
+	bool empty() const
+	{ return order.empty(); }
+
+private:
+	/*
+	 * segment with its line: beginning and slope, or range of y if segment is vertical
+	 * tolerance is distance from sweep point at which segment still passes through it
+	 */
+	struct Entry {
+		double x1, y1, slope;
+		double low, high;
+		double tolerance;
+		bool vertical;
+		int number;
+		Segment *segment;
+	};
+
+	/*
+	 * block of sorted entries, linked with neighbouring blocks
+	 * rank is place of block in order of blocks
+	 */
+	struct Block {
+		std::vector<Entry> entries;
+		int prev, next;
+		int rank;
+	};
+
+	/*
+	 * create entry of given segment
+	 */
+	static Entry makeEntry( Segment *s );
+	/*
+	 * get y coordinate of crossing of entry with sweep line
+	 */
+	double key( const Entry& e ) const
+	{
+		if( e.vertical )
+			return std::max( e.low, std::min( sweep_y, e.high ) );
+		return e.y1 + ( sweep_x - e.x1 ) * e.slope;
+	}
+	/*
+	 * test whether entry a lies below entry b just after current point of sweep line
+	 * keys of entries are given, so they are computed only once
+	 */
+	static bool below( const Entry& a, double ka, const Entry& b, double kb );
+
+	/*
+	 * create new empty block placed at given rank
+	 */
+	int createBlock( int rank );
+	/*
+	 * remove empty block
+	 */
+	void removeBlock( int id );
+	/*
+	 * update positions of entries of block from given offset and fence of block
+	 */
+	void update( int id, int from = 0 );
+
+	/*
+	 * current point of sweep line
+	 */
+	double sweep_x, sweep_y;
+	/*
+	 * every block, also unused ones waiting in free_blocks
+	 */
+	std::vector<Block> blocks;
+	std::vector<int> free_blocks;
+	/*
+	 * blocks in order of entries and their last entries
+	 */
+	std::vector<int> order;
+	std::vector<Entry> fences;
+	/*
+	 * position of every segment in status, block is -1 for segments not in status
+	 */
+	std::vector<Position> where;
+};
+
+#endif
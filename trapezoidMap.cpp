@@ -0,0 +1,421 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  trapezoidMap.cpp
+ *
+ *    Description:  Randomized trapezoidal map of segments finding their intersections and locating points.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 08:53:24
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "trapezoidMap.h"
+#include "spatialIndex.h"
+
+void TrapezoidMap::build( const std::vector<Segment>& s, const Reporter& r, unsigned int seed )
+{
+	clear();
+	segments = &s;
+	report = r;
+
+	std::vector<int> vertical;
+	for( unsigned int i = 0; i < s.size(); ++i )
+	{
+		SegmentData *d = s[i].getData();
+		if( d->vertical ) {
+			vertical.push_back( i );
+			continue;
+		}
+		Line l = { d->x1, d->y1, d->x2, d->y2, d->slope, d->tolerance, d->number, (int)i };
+		lines.push_back( l );
+		max_tolerance = std::max( max_tolerance, d->tolerance );
+	}
+
+	//random order of insertion keeps expected depth of search structure logarithmic
+	std::default_random_engine engine( seed );
+	std::shuffle( lines.begin(), lines.end(), engine );
+	//ending points alone add four trapezoids and ten nodes for every segment, crossings add more
+	trapezoids.reserve( 4 * lines.size() + 1 );
+	nodes.reserve( 10 * lines.size() + 1 );
+	vertices.reserve( 2 * lines.size() );
+	tested.assign( lines.size(), -1 );
+	line_vertices.resize( lines.size() );
+	group.assign( lines.size(), -1 );
+	for( unsigned int i = 0; i < lines.size(); ++i )
+		insert( i );
+
+	if( !vertical.empty() ) {
+		SpatialIndex index;
+		index.build( s );
+		index.crossingsOfVertical( s, vertical, report );
+	}
+}
+
+void TrapezoidMap::clear()
+{
+	segments = nullptr;
+	lines.clear();
+	trapezoids.clear();
+	trapezoids_count = 0;
+	nodes.clear();
+	vertices.clear();
+	links.clear();
+	line_vertices.clear();
+	group.clear();
+	groups.clear();
+	tested.clear();
+	max_tolerance = 0;
+
+	//empty map is single trapezoid covering whole plane
+	double infinity = std::numeric_limits<double>::infinity();
+	createTrapezoid( -1, -1, -infinity, infinity );
+}
+
+void TrapezoidMap::locate( double x, double y, int& above, int& below ) const
+{
+	int n = 0;
+	while( nodes[n].type != Node::LEAF )
+	{
+		const Node& node = nodes[n];
+		if( node.type == Node::X_NODE )
+			n = x < node.x ? node.left : node.right;
+		else
+			n = y >= lineY( lines[node.value], x ) ? node.right : node.left;
+	}
+	const Trapezoid& d = trapezoids[ nodes[n].value ];
+	above = d.top == -1 ? -1 : lines[d.top].index;
+	below = d.bottom == -1 ? -1 : lines[d.bottom].index;
+}
+
+void TrapezoidMap::insert( int line )
+{
+	const Line& l = lines[line];
+	std::vector<Visit> visits;
+
+	//ending points lying on bounding segments are joined with them
+	auto onLine = [&]( int other, double x ) {
+		if( other == -1 || std::abs( lineY( lines[other], x ) - lineY( l, x ) ) > l.tolerance + lines[other].tolerance )
+			return -1;
+		return other;
+	};
+
+	int t = locate( line, l.x1 );
+	addVertex( line, l.x1, onLine( trapezoids[t].top, l.x1 ), onLine( trapezoids[t].bottom, l.x1 ) );
+
+	//lines crossed at current x, so line never goes back through crossing of many lines
+	double from = l.x1;
+	std::vector<int> crossed;
+	while( true )
+	{
+		const Trapezoid& d = trapezoids[t];
+		check( line, d.top );
+		check( line, d.bottom );
+
+		double to = std::min( d.right, l.x2 );
+		//line overlapping bounding segment touches every vertex on segments lying on it
+		for( int side : { d.top, d.bottom } )
+		{
+			if( from == to || onLine( side, from ) == -1 || onLine( side, to ) == -1 )
+				continue;
+			overlap( line, side );
+			for( int o : groups[ group[side] ] )
+			{
+				if( o == line )
+					continue;
+				for( double x : line_vertices[o] )
+				{
+					if( x > from && x < to )
+						touchVertices( line, x );
+				}
+			}
+		}
+		int other = -1;
+		bool up = false;
+		if( d.top != -1 && std::find( crossed.begin(), crossed.end(), d.top ) == crossed.end()
+				&& lineY( l, to ) - lineY( lines[d.top], to ) > l.tolerance + lines[d.top].tolerance ) {
+			other = d.top;
+			up = true;
+		}
+		else if( d.bottom != -1 && std::find( crossed.begin(), crossed.end(), d.bottom ) == crossed.end()
+				&& lineY( lines[d.bottom], to ) - lineY( l, to ) > l.tolerance + lines[d.bottom].tolerance ) {
+			other = d.bottom;
+		}
+
+		if( other != -1 ) {
+			//crossing is computed the same way as reported one, so it meets vertices lying there exactly
+			const Line& c = lines[other];
+			double x, y;
+			if( !segmentsIntersect( l.x1, l.y1, l.x2, l.y2, c.x1, c.y1, c.x2, c.y2, x, y ) )
+				x = from + ( lineY( c, from ) - lineY( l, from ) ) / ( l.slope - c.slope );
+			if( !( x >= from ) )
+				x = from;
+			x = std::min( x, to );
+			//line ending on crossed segment is handled by its ending point
+			if( x < l.x2 ) {
+				Visit v = { t, from, x, CROSSING };
+				visits.push_back( v );
+				addVertex( line, x, other );
+				if( x != from )
+					crossed.clear();
+				crossed.push_back( other );
+				from = x;
+				t = locate( line, x, other, up );
+				continue;
+			}
+		}
+
+		if( to == l.x2 ) {
+			Visit v = { t, from, to, END };
+			visits.push_back( v );
+			break;
+		}
+		Visit v = { t, from, to, WALL };
+		visits.push_back( v );
+		//line touching bounding segment on wall crosses it or ends on it there
+		int top = onLine( d.top, to ), bottom = onLine( d.bottom, to );
+		if( top != -1 || bottom != -1 )
+			addVertex( line, to, top, bottom );
+		else
+			touchVertices( line, to );
+		from = to;
+		crossed.clear();
+		t = locate( line, from );
+	}
+
+	addVertex( line, l.x2, onLine( trapezoids[t].top, l.x2 ), onLine( trapezoids[t].bottom, l.x2 ) );
+	split( line, visits );
+}
+
+void TrapezoidMap::split( int line, const std::vector<Visit>& visits )
+{
+	//trapezoids above and below line are extended through walls not reaching line
+	int above = -1, below = -1;
+	Exit previous = CROSSING;
+	for( const Visit& v : visits )
+	{
+		Trapezoid d = trapezoids[v.trapezoid];
+		int node;
+		if( v.from == v.to ) {
+			//line only touches trapezoid, its wall cuts it in two
+			above = below = -1;
+			previous = v.exit;
+			if( v.from == d.left )
+				continue;
+			int right = createTrapezoid( d.top, d.bottom, v.to, d.right );
+			int left = createTrapezoid( d.top, d.bottom, d.left, v.from );
+			node = createNode( Node::X_NODE, v.from, -1, trapezoids[left].node, trapezoids[right].node );
+		}
+		else {
+			bool joined = previous == WALL;
+			if( above != -1 && joined && trapezoids[above].top == d.top && !separated( line, d.top, v.from, true ) )
+				trapezoids[above].right = v.to;
+			else
+				above = createTrapezoid( d.top, line, v.from, v.to );
+			if( below != -1 && joined && trapezoids[below].bottom == d.bottom && !separated( line, d.bottom, v.from, false ) )
+				trapezoids[below].right = v.to;
+			else
+				below = createTrapezoid( line, d.bottom, v.from, v.to );
+
+			node = createNode( Node::LINE_NODE, 0, line, trapezoids[below].node, trapezoids[above].node );
+			if( v.to < d.right ) {
+				int right = createTrapezoid( d.top, d.bottom, v.to, d.right );
+				node = createNode( Node::X_NODE, v.to, -1, node, trapezoids[right].node );
+			}
+			if( v.from > d.left ) {
+				int left = createTrapezoid( d.top, d.bottom, d.left, v.from );
+				node = createNode( Node::X_NODE, v.from, -1, trapezoids[left].node, node );
+			}
+			previous = v.exit;
+		}
+
+		//leaf of split trapezoid becomes root of its parts, so every path leading to it stays valid
+		nodes[d.node] = nodes[node];
+		nodes.pop_back();
+		trapezoids[v.trapezoid].node = -1;
+		--trapezoids_count;
+	}
+}
+
+int TrapezoidMap::locate( int line, double x, int forced, bool above ) const
+{
+	int n = 0;
+	while( nodes[n].type != Node::LEAF )
+	{
+		const Node& node = nodes[n];
+		bool right;
+		if( node.type == Node::X_NODE )
+			right = !( x < node.x );
+		else if( node.value == forced )
+			right = above;
+		else
+			right = lineAbove( line, node.value, x );
+		n = right ? node.right : node.left;
+	}
+	return nodes[n].value;
+}
+
+bool TrapezoidMap::lineAbove( int a, int b, double x ) const
+{
+	const Line& p = lines[a];
+	const Line& q = lines[b];
+	double difference = lineY( p, x ) - lineY( q, x );
+	double tolerance = p.tolerance + q.tolerance;
+	if( difference > tolerance )
+		return true;
+	if( difference < -tolerance )
+		return false;
+	//lines touching at x are ordered as just after it
+	if( p.slope != q.slope )
+		return p.slope > q.slope;
+	return p.number > q.number;
+}
+
+void TrapezoidMap::check( int line, int other )
+{
+	if( other == -1 )
+		return;
+	if( group[other] == -1 ) {
+		compare( line, other );
+		return;
+	}
+	for( int l : groups[ group[other] ] )
+		compare( line, l );
+}
+
+void TrapezoidMap::compare( int line, int other )
+{
+	if( other == line || tested[other] == line )
+		return;
+	tested[other] = line;
+
+	const std::vector<Segment>& s = *segments;
+	double x, y;
+	if( s[ lines[line].index ].intersects( s[ lines[other].index ], x, y ) )
+		report( lines[line].index, lines[other].index, x, y );
+}
+
+void TrapezoidMap::overlap( int line, int other )
+{
+	int a = group[line], b = group[other];
+	if( a != -1 && a == b )
+		return;
+	if( b == -1 ) {
+		std::swap( a, b );
+		std::swap( line, other );
+	}
+	if( b == -1 ) {
+		b = groups.size();
+		groups.push_back( std::vector<int>( 1, other ) );
+		group[other] = b;
+	}
+	if( a == -1 ) {
+		groups[b].push_back( line );
+		group[line] = b;
+		return;
+	}
+
+	//smaller group is moved into bigger one
+	if( groups[a].size() > groups[b].size() )
+		std::swap( a, b );
+	for( int l : groups[a] )
+	{
+		group[l] = b;
+		groups[b].push_back( l );
+	}
+	std::vector<int>().swap( groups[a] );
+}
+
+bool TrapezoidMap::touchVertices( int line, double x )
+{
+	//every vertex has its own wall, so line reaches vertices lying on it exactly at their x coordinate
+	auto column = vertices.find( x );
+	if( column == vertices.end() )
+		return false;
+
+	const Line& l = lines[line];
+	double y = lineY( l, x );
+	double tolerance = l.tolerance + max_tolerance;
+	auto& list = column->second;
+	bool found = false;
+	for( auto v = std::partition_point( list.begin(), list.end(), [&]( const Vertex& v ) { return v.y < y - tolerance; } );
+			v != list.end() && v->y <= y + tolerance; ++v )
+	{
+		for( int k = v->first; k != -1; k = links[k].next )
+			check( line, links[k].line );
+		addLink( *v, x, line );
+		found = true;
+	}
+	return found;
+}
+
+void TrapezoidMap::addVertex( int line, double x, int other1, int other2 )
+{
+	if( touchVertices( line, x ) )
+		return;
+
+	Vertex v = { lineY( lines[line], x ), -1 };
+	addLink( v, x, line );
+	if( other1 != -1 )
+		addLink( v, x, other1 );
+	if( other2 != -1 )
+		addLink( v, x, other2 );
+	auto& list = vertices[x];
+	list.insert( std::partition_point( list.begin(), list.end(), [&]( const Vertex& w ) { return w.y < v.y; } ), v );
+}
+
+void TrapezoidMap::addLink( Vertex& v, double x, int line )
+{
+	Link k = { line, v.first };
+	links.push_back( k );
+	v.first = links.size() - 1;
+	line_vertices[line].push_back( x );
+}
+
+bool TrapezoidMap::separated( int line, int other, double x, bool above ) const
+{
+	auto column = vertices.find( x );
+	if( column == vertices.end() )
+		return false;
+
+	//vertices lying on either line count, their walls reach space between lines as well
+	const Line& l = lines[line];
+	double infinity = std::numeric_limits<double>::infinity();
+	double low, high;
+	if( above ) {
+		low = lineY( l, x ) - l.tolerance;
+		high = other == -1 ? infinity : lineY( lines[other], x ) + lines[other].tolerance;
+	}
+	else {
+		low = other == -1 ? -infinity : lineY( lines[other], x ) - lines[other].tolerance;
+		high = lineY( l, x ) + l.tolerance;
+	}
+	const auto& list = column->second;
+	auto v = std::partition_point( list.begin(), list.end(), [&]( const Vertex& v ) { return v.y < low; } );
+	return v != list.end() && v->y <= high;
+}
+
+int TrapezoidMap::createTrapezoid( int top, int bottom, double left, double right )
+{
+	Trapezoid d = { top, bottom, left, right, createNode( Node::LEAF, 0, trapezoids.size(), -1, -1 ) };
+	trapezoids.push_back( d );
+	++trapezoids_count;
+	return trapezoids.size() - 1;
+}
+
+int TrapezoidMap::createNode( Node::Type type, double x, int value, int left, int right )
+{
+	Node n = { type, x, value, left, right };
+	nodes.push_back( n );
+	return nodes.size() - 1;
+}
@@ -0,0 +1,246 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  trapezoidMap.h
+ *
+ *    Description:  Randomized trapezoidal map of segments finding their intersections and locating points.
+ *
+ *        Version:  1.0
+ *        Created:  18.10.2026 08:53:24
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Michał Glinka
+ *   Organization:  Politechnika Warszawska
+ *
+ * =====================================================================================
+ */
+#ifndef TRAPEZOID_MAP_H
+#define TRAPEZOID_MAP_H
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "segment.h"
+
+/*
+ * trapezoidal decomposition of segments built by inserting them in random order
+ * every ending point and crossing of segments has vertical walls going up and down to nearest segments
+ * inserted segment is traced through trapezoids it passes, segments bounding them are the only ones it can cross
+ * history of splitting trapezoids is kept as search structure, so after building
+ * segments directly above and below any point are found in expected O(log n) time
+ * vertical segments have no width, they are not kept in map and their crossings are found with spatial index
+ */
+class TrapezoidMap
+{
+public:
+	/*
+	 * function called for every found intersection with indices of crossing segments and coordinates of crossing
+	 */
+	typedef std::function<void( int, int, double, double )> Reporter;
+
+	TrapezoidMap()
+	{ clear(); }
+
+	/*
+	 * build map of given segments inserted in order shuffled with given seed, previous content is removed
+	 * every pair of crossing segments is reported once
+	 */
+	void build( const std::vector<Segment>& segments, const Reporter& report, unsigned int seed );
+
+	/*
+	 * remove every segment from map
+	 */
+	void clear();
+
+	/*
+	 * return whether map holds no segments
+	 */
+	bool empty() const
+	{ return lines.empty(); }
+
+	/*
+	 * find indices of segments directly above and below given point, -1 if there is no such segment
+	 * point lying on segment is taken as lying above it
+	 */
+	void locate( double x, double y, int& above, int& below ) const;
+
+	/*
+	 * get number of trapezoids of map
+	 */
+	int getTrapezoidsCount() const
+	{ return trapezoids_count; }
+
+private:
+	/*
+	 * non vertical segment with its line
+	 */
+	struct Line {
+		double x1, y1, x2, y2;
+		double slope, tolerance;
+		int number;
+		int index;
+	};
+
+	/*
+	 * part of plane between two segments and two vertical walls, -1 means there is no segment
+	 * trapezoid contains points from its left wall to its right wall, right wall excluded
+	 * node is leaf of search structure pointing to this trapezoid, -1 after trapezoid was split
+	 */
+	struct Trapezoid {
+		int top, bottom;
+		double left, right;
+		int node;
+	};
+
+	/*
+	 * node of search structure
+	 * x node sends points left of its x to left child, line node sends points below its line to left child
+	 * value is line of line node or trapezoid of leaf
+	 */
+	struct Node {
+		enum Type { LEAF, X_NODE, LINE_NODE };
+
+		Type type;
+		double x;
+		int value;
+		int left, right;
+	};
+
+	/*
+	 * ending point or crossing of segments, walls of trapezoids go from it
+	 * segments passing through it are kept in list starting with first link
+	 */
+	struct Vertex {
+		double y;
+		int first;
+	};
+
+	/*
+	 * single element of list of segments passing through vertex
+	 */
+	struct Link {
+		int line;
+		int next;
+	};
+
+	/*
+	 * trapezoid passed by inserted segment between given x coordinates
+	 * exit tells how segment leaves trapezoid: through its right wall, by crossing its top or bottom, or by ending
+	 */
+	enum Exit { WALL, CROSSING, END };
+	struct Visit {
+		int trapezoid;
+		double from, to;
+		Exit exit;
+	};
+
+	/*
+	 * insert line of given index, trace it through map and split trapezoids it passes
+	 */
+	void insert( int line );
+	/*
+	 * replace trapezoids passed by line with trapezoids above and below it and parts it doesn't pass
+	 */
+	void split( int line, const std::vector<Visit>& visits );
+
+	/*
+	 * find trapezoid containing points of line just after given x coordinate
+	 * if forced line is given, points are taken as lying above it or below it
+	 */
+	int locate( int line, double x, int forced = -1, bool above = false ) const;
+	/*
+	 * test whether line a lies above line b just after given x coordinate
+	 */
+	bool lineAbove( int a, int b, double x ) const;
+	/*
+	 * get y coordinate of line at given x, ending points are returned exactly
+	 */
+	double lineY( const Line& l, double x ) const
+	{
+		if( x == l.x1 )
+			return l.y1;
+		if( x == l.x2 )
+			return l.y2;
+		return l.y1 + ( x - l.x1 ) * l.slope;
+	}
+
+	/*
+	 * test line with other line and with every line overlapping it
+	 */
+	void check( int line, int other );
+	/*
+	 * test whether lines cross and report them, every pair is tested once for inserted line
+	 */
+	void compare( int line, int other );
+	/*
+	 * join groups of lines lying on each other, such lines touch the same segments
+	 */
+	void overlap( int line, int other );
+	/*
+	 * test line with every segment passing through vertices lying on it at given x and add line to them
+	 * return whether there was such vertex
+	 */
+	bool touchVertices( int line, double x );
+	/*
+	 * add vertex of line at given x, also lying on given other lines
+	 * if line passes through existing vertex there, it is joined with it instead
+	 */
+	void addVertex( int line, double x, int other1 = -1, int other2 = -1 );
+	/*
+	 * add line to list of segments passing through vertex at given x, which is remembered for line as well
+	 */
+	void addLink( Vertex& v, double x, int line );
+	/*
+	 * test whether some vertex on given x lies between two lines, so its wall separates trapezoids on both sides of x
+	 * other line -1 means unbounded side
+	 */
+	bool separated( int line, int other, double x, bool above ) const;
+
+	/*
+	 * create trapezoid with its leaf in search structure
+	 */
+	int createTrapezoid( int top, int bottom, double left, double right );
+	int createNode( Node::Type type, double x, int value, int left, int right );
+
+	/*
+	 * segments kept in map
+	 */
+	const std::vector<Segment> *segments;
+	std::vector<Line> lines;
+	/*
+	 * every trapezoid ever created, split ones have no node
+	 */
+	std::vector<Trapezoid> trapezoids;
+	int trapezoids_count;
+	/*
+	 * search structure, its root is first node
+	 */
+	std::vector<Node> nodes;
+	/*
+	 * vertices grouped by x coordinate and sorted by y, with lists of lines passing through them
+	 */
+	std::unordered_map<double, std::vector<Vertex> > vertices;
+	std::vector<Link> links;
+	/*
+	 * x coordinates of vertices lying on every line, segments overlapping line pass through them without walls
+	 */
+	std::vector<std::vector<double> > line_vertices;
+	/*
+	 * group of overlapping lines of every line, -1 if it overlaps no other line
+	 */
+	std::vector<int> group;
+	std::vector<std::vector<int> > groups;
+	/*
+	 * inserted line which was last tested with every line, so every pair is tested once
+	 */
+	std::vector<int> tested;
+	/*
+	 * the biggest tolerance of any line
+	 */
+	double max_tolerance;
+	Reporter report;
+};
+
+#endif